@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include "../dfa/read_dfa_from_file.h"
+#include "../dfa/compiled_dfa.h"
+
+// Every run benchmark reads about this many bytes, split into inputs of the benchmarked size
+#define RUN_BUDGET (16u << 20)
+
+static const size_t input_sizes[] = {16, 256, 4096, 65536, 1u << 20, 16u << 20};
+
+typedef enum Input_Kind {
+    WALK_INPUT,  // random walk through the DFA that avoids dead states where it can
+    RANDOM_INPUT // uniformly random letters out of those that lead anywhere but to the garbage state
+} Input_Kind;
+
+// Helper functions declarations
+
+double now();
+
+// Returns the number of bytes allocated on the heap
+size_t heap_in_use();
+
+unsigned long long next_random(unsigned long long *random_state);
+
+// Fills the buffer with the given kind of input. A walk starts over from state 0 every input_size bytes.
+void generate_input(struct DFA *dfa, Input_Kind kind, char *buffer, size_t length, size_t input_size);
+
+void print_json_string(const char *string);
+
+// Loads the DFA the given number of times and prints the fastest load time together with the DFA's footprint.
+// Returns the last loaded DFA, or NULL if it could not be loaded.
+struct DFA *benchmark_load(const char *filename, unsigned repetitions);
+
+void benchmark_run(const char *filename, struct DFA *dfa, Input_Kind kind, size_t input_size, unsigned repetitions);
+
+void print_usage(const char *program);
+
+int main(int argc, char *argv[]) {
+    unsigned repetitions = 3;
+    int first_file = 1;
+    if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+        repetitions = (unsigned) strtoul(argv[2], NULL, 10);
+        first_file = 3;
+    }
+    if (first_file >= argc || repetitions == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    for (int i = first_file; i < argc; i++) {
+        struct DFA *dfa = benchmark_load(argv[i], repetitions);
+        if (dfa == NULL) {
+            return 1;
+        }
+        for (size_t s = 0; s < sizeof(input_sizes) / sizeof(input_sizes[0]); s++) {
+            benchmark_run(argv[i], dfa, WALK_INPUT, input_sizes[s], repetitions);
+            benchmark_run(argv[i], dfa, RANDOM_INPUT, input_sizes[s], repetitions);
+        }
+        delete_DFA(dfa);
+    }
+    return 0;
+}
+
+// Helper functions definitions
+
+double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+size_t heap_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+unsigned long long next_random(unsigned long long *random_state) {
+    *random_state ^= *random_state << 13;
+    *random_state ^= *random_state >> 7;
+    *random_state ^= *random_state << 17;
+    return *random_state;
+}
+
+void generate_input(struct DFA *dfa, Input_Kind kind, char *buffer, size_t length, size_t input_size) {
+    unsigned long long random_state = 0x9E3779B97F4A7C15ULL;
+    const struct Compiled_DFA *compiled = get_compiled_DFA(dfa);
+    if (kind == RANDOM_INPUT) {
+        unsigned char alphabet[DFA_ALPHABET_SIZE];
+        unsigned alphabet_size = 0;
+        for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+            unsigned state = 0;
+            while (state < compiled->garbage_state && get_compiled_transition(compiled, state, (unsigned char) letter) == compiled->garbage_state) {
+                state++;
+            }
+            if (state < compiled->garbage_state) {
+                alphabet[alphabet_size++] = (unsigned char) letter;
+            }
+        }
+        for (size_t i = 0; i < length; i++) {
+            buffer[i] = (char) (alphabet_size > 0 ? alphabet[next_random(&random_state) % alphabet_size] : 0);
+        }
+        return;
+    }
+
+    // The letters of every letter class, so a walk can pick a class first and then one of its letters
+    unsigned char class_letters[DFA_ALPHABET_SIZE];
+    unsigned class_start[DFA_ALPHABET_SIZE + 1] = {0};
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        class_start[compiled->letter_classes[letter] + 1]++;
+    }
+    for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+        class_start[c + 1] += class_start[c];
+    }
+    unsigned class_fill[DFA_ALPHABET_SIZE];
+    memcpy(class_fill, class_start, sizeof(class_fill));
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        class_letters[class_fill[compiled->letter_classes[letter]]++] = (unsigned char) letter;
+    }
+
+    unsigned state = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (i % input_size == 0) {
+            state = 0;
+        }
+        // A random class, or the next one after it that does not lead to a dead state
+        unsigned first_class = (unsigned) (next_random(&random_state) % compiled->number_of_classes);
+        unsigned letter_class = first_class;
+        unsigned destination = get_compiled_class_transition(compiled, state, letter_class);
+        for (unsigned c = 1; c < compiled->number_of_classes && is_compiled_state_dead(compiled, destination); c++) {
+            letter_class = (first_class + c) % compiled->number_of_classes;
+            destination = get_compiled_class_transition(compiled, state, letter_class);
+        }
+        if (is_compiled_state_dead(compiled, destination)) {
+            letter_class = first_class;
+            destination = get_compiled_class_transition(compiled, state, letter_class);
+        }
+        unsigned class_size = class_start[letter_class + 1] - class_start[letter_class];
+        buffer[i] = (char) class_letters[class_start[letter_class] + next_random(&random_state) % class_size];
+        state = destination;
+    }
+}
+
+void print_json_string(const char *string) {
+    putchar('"');
+    for (; *string != '\0'; string++) {
+        if (*string == '"' || *string == '\\') {
+            printf("\\%c", *string);
+        } else if ((unsigned char) *string < 0x20) {
+            printf("\\u%04x", *string);
+        } else {
+            putchar(*string);
+        }
+    }
+    putchar('"');
+}
+
+struct DFA *benchmark_load(const char *filename, unsigned repetitions) {
+    struct DFA *dfa = NULL;
+    double best = 0;
+    size_t heap_bytes = 0;
+    for (unsigned r = 0; r < repetitions; r++) {
+        delete_DFA(dfa);
+        size_t heap_before = heap_in_use();
+        double start = now();
+        dfa = read_dfa_from_file(filename, 1);
+        double elapsed = now() - start;
+        if (dfa == NULL) {
+            return NULL;
+        }
+
+        // The transition table is built on the first run, so it is part of the footprint
+        build_DFA_table(dfa);
+        heap_bytes = heap_in_use() - heap_before;
+        best = r == 0 || elapsed < best ? elapsed : best;
+    }
+
+    printf("{\"file\": ");
+    print_json_string(filename);
+    printf(
+        ", \"benchmark\": \"load\", \"states\": %u, \"letter_classes\": %u, \"state_id_width\": %u"
+        ", \"table_bytes\": %zu, \"heap_bytes\": %zu, \"seconds\": %.9f}\n",
+        get_number_of_states(dfa), get_DFA_number_of_letter_classes(dfa), get_DFA_state_id_width(dfa),
+        get_DFA_table_size(dfa), heap_bytes, best
+    );
+    fflush(stdout);
+    return dfa;
+}
+
+void benchmark_run(const char *filename, struct DFA *dfa, Input_Kind kind, size_t input_size, unsigned repetitions) {
+    size_t number_of_inputs = input_size < RUN_BUDGET ? RUN_BUDGET / input_size : 1;
+    size_t length = number_of_inputs * input_size;
+    char *buffer = (char*) malloc(length);
+    generate_input(dfa, kind, buffer, length, input_size);
+
+    double best = 0;
+    size_t accepted = 0;
+    for (unsigned r = 0; r < repetitions; r++) {
+        accepted = 0;
+        double start = now();
+        for (size_t i = 0; i < number_of_inputs; i++) {
+            accepted += run_DFA(dfa, buffer + i * input_size, (unsigned) input_size);
+        }
+        double elapsed = now() - start;
+        best = r == 0 || elapsed < best ? elapsed : best;
+    }
+    free(buffer);
+
+    // The number of ACCEPTED inputs keeps the runs from being optimized away and catches changes in the results
+    printf("{\"file\": ");
+    print_json_string(filename);
+    printf(
+        ", \"benchmark\": \"run\", \"input\": \"%s\", \"input_size\": %zu, \"inputs\": %zu, \"accepted\": %zu"
+        ", \"seconds\": %.9f, \"bytes_per_second\": %.0f, \"inputs_per_second\": %.0f}\n",
+        kind == WALK_INPUT ? "walk" : "random", input_size, number_of_inputs, accepted,
+        best, length / best, number_of_inputs / best
+    );
+    fflush(stdout);
+}
+
+void print_usage(const char *program) {
+    fprintf(
+        stderr,
+        "Usage: %s [-r repetitions] <DFA file>...\n"
+        "  Prints one JSON object per line: the load time and memory footprint of every DFA,\n"
+        "  and the run_DFA throughput on inputs of several sizes (the fastest of the repetitions).\n",
+        program
+    );
+}
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../dfa/dfa_regex.h"
+#include "../dfa/lazy_dfa.h"
+
+// Inputs of up to this many letters are all tried
+#define MAX_INPUT_LENGTH 5
+
+// Letters of the patterns' alphabets, plus one letter that none of the default patterns uses
+#define MAX_ALPHABET_SIZE 16
+
+static const char *default_patterns[] = {
+    "xa*y", "ab|cd", "x[0-9]+y", "(a|b)*abb", "a(b|c)*d", "((ab)*|c)+d?", "[a-c]+x[a-c]*"
+};
+
+// Helper functions declarations
+
+// Collects the letters that appear in the pattern, apart from the operators, and one that does not.
+// Returns the number of letters.
+unsigned collect_pattern_letters(const char *pattern, char *letters);
+
+// Runs the lazy DFA with a cache that is cleared after every state built against the full DFA on all inputs
+// over the letters. Returns the number of inputs on which they differ.
+unsigned check_pattern(const char *pattern);
+
+void print_usage(const char *program);
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "-h") == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    unsigned mismatches = 0;
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            mismatches += check_pattern(argv[i]);
+        }
+    } else {
+        for (size_t i = 0; i < sizeof(default_patterns) / sizeof(default_patterns[0]); i++) {
+            mismatches += check_pattern(default_patterns[i]);
+        }
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Helper functions definitions
+
+unsigned collect_pattern_letters(const char *pattern, char *letters) {
+    unsigned count = 0;
+    for (const char *c = pattern; *c != '\0' && count + 1 < MAX_ALPHABET_SIZE; c++) {
+        if (strchr("()|*+?[]-\\.", *c) == NULL && memchr(letters, *c, count) == NULL) {
+            letters[count++] = *c;
+        }
+    }
+    letters[count++] = 'q';
+    return count;
+}
+
+unsigned check_pattern(const char *pattern) {
+    struct DFA *dfa = make_DFA_from_regex(pattern, 1);
+    struct Lazy_DFA *lazy = make_lazy_DFA_from_regex(pattern, 1);
+    if (dfa == NULL || lazy == NULL) {
+        delete_DFA(dfa);
+        delete_lazy_DFA(lazy);
+        return 1;
+    }
+    set_lazy_DFA_cache_size(lazy, 0);
+
+    char letters[MAX_ALPHABET_SIZE];
+    unsigned number_of_letters = collect_pattern_letters(pattern, letters);
+
+    // Every input is a number in base number_of_letters, with one digit per letter
+    char input[MAX_INPUT_LENGTH];
+    unsigned mismatches = 0;
+    for (unsigned length = 0; length <= MAX_INPUT_LENGTH; length++) {
+        unsigned long inputs = 1;
+        for (unsigned i = 0; i < length; i++) {
+            inputs *= number_of_letters;
+        }
+        for (unsigned long n = 0; n < inputs; n++) {
+            unsigned long digits = n;
+            for (unsigned i = 0; i < length; i++) {
+                input[i] = letters[digits % number_of_letters];
+                digits /= number_of_letters;
+            }
+            int expected = run_DFA(dfa, input, length);
+            int result = run_lazy_DFA(lazy, input, length);
+            if (result != expected) {
+                if (mismatches == 0) {
+                    printf("\"%s\": the lazy DFA %s \"%.*s\"\n", pattern, result ? "accepts" : "rejects", (int) length, input);
+                }
+                mismatches++;
+            }
+        }
+    }
+    printf(
+        "\"%s\": %u mismatches, cache cleared %u times\n",
+        pattern, mismatches, get_lazy_DFA_cache_clears(lazy)
+    );
+
+    delete_lazy_DFA(lazy);
+    delete_DFA(dfa);
+    return mismatches;
+}
+
+void print_usage(const char *program) {
+    fprintf(
+        stderr,
+        "Usage: %s [pattern]...\n"
+        "  Runs lazy DFAs whose cache is cleared after every state built against the full DFAs of the patterns\n"
+        "  (or of a default set) on all short inputs over the patterns' letters. Exits with 1 if any result differs.\n",
+        program
+    );
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Letters that can appear in a DFA description: the printable ASCII characters and then the bytes from 128 up
+#define MAX_ALPHABET_SIZE (94 + 128)
+
+// Shapes of the generated automata
+typedef enum Shape {
+    RANDOM_SHAPE, // every transition leads to a random state
+    CHAIN_SHAPE,  // a keyword: a path of states that falls back to the start on a wrong letter
+    CYCLE_SHAPE   // a counter: every letter moves the state forward by a fixed amount
+} Shape;
+
+// Small xorshift generator, so the same seed gives the same DFA on every platform
+unsigned long long random_state;
+
+unsigned next_random(unsigned bound) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return (unsigned) ((random_state >> 11) % bound);
+}
+
+char letter_of(unsigned k) {
+    return (char) (k < 94 ? '!' + k : 128 + (k - 94));
+}
+
+// Returns the destination of the transition, or the number of states if it should lead to the garbage state
+unsigned choose_destination(Shape shape, unsigned number_of_states, unsigned alphabet_size, unsigned density, unsigned state, unsigned k) {
+    // The last state of a keyword loops on every letter, so inputs that contain the keyword are ACCEPTED
+    if (shape == CHAIN_SHAPE && state == number_of_states - 1) {
+        return state;
+    }
+    if (shape == CHAIN_SHAPE && k == state % alphabet_size) {
+        return state + 1;
+    }
+    if (next_random(100) >= density) {
+        return number_of_states;
+    }
+    switch (shape) {
+    case RANDOM_SHAPE:
+        return next_random(number_of_states);
+    case CHAIN_SHAPE:
+        return 0;
+    default:
+        return (state + k + 1) % number_of_states;
+    }
+}
+
+int is_final(Shape shape, unsigned number_of_states, unsigned state) {
+    switch (shape) {
+    case RANDOM_SHAPE:
+        return next_random(8) == 0;
+    case CHAIN_SHAPE:
+        return state == number_of_states - 1;
+    default:
+        return state == 0;
+    }
+}
+
+void print_usage(const char *program) {
+    fprintf(
+        stderr,
+        "Usage: %s <random|chain|cycle> <number of states> <alphabet size> <density> [seed]\n"
+        "  Prints a DFA description. The alphabet size is between 1 and %d, and the density is the percentage (0 to 100)\n"
+        "  of pairs of state and letter that get a transition; the others lead to the garbage state.\n",
+        program, MAX_ALPHABET_SIZE
+    );
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 5 || argc > 6) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    Shape shape;
+    if (strcmp(argv[1], "random") == 0) {
+        shape = RANDOM_SHAPE;
+    } else if (strcmp(argv[1], "chain") == 0) {
+        shape = CHAIN_SHAPE;
+    } else if (strcmp(argv[1], "cycle") == 0) {
+        shape = CYCLE_SHAPE;
+    } else {
+        print_usage(argv[0]);
+        return 1;
+    }
+    unsigned number_of_states = (unsigned) strtoul(argv[2], NULL, 10);
+    unsigned alphabet_size = (unsigned) strtoul(argv[3], NULL, 10);
+    unsigned density = (unsigned) strtoul(argv[4], NULL, 10);
+    random_state = argc == 6 ? strtoull(argv[5], NULL, 10) : 1;
+    if (number_of_states == 0 || alphabet_size == 0 || alphabet_size > MAX_ALPHABET_SIZE || density > 100) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    random_state = random_state * 0x9E3779B97F4A7C15ULL + 1;
+
+    printf("%u\n", number_of_states);
+    int has_final_states = 0;
+    for (unsigned state = 0; state < number_of_states; state++) {
+        if (is_final(shape, number_of_states, state)) {
+            printf(has_final_states ? " %u" : "%u", state);
+            has_final_states = 1;
+        }
+    }
+    printf(has_final_states ? "\n" : "NONE\n");
+
+    for (unsigned state = 0; state < number_of_states; state++) {
+        for (unsigned k = 0; k < alphabet_size; k++) {
+            unsigned destination = choose_destination(shape, number_of_states, alphabet_size, density, state, k);
+            if (destination < number_of_states) {
+                printf("%u -> %u : %c\n", state, destination, letter_of(k));
+            }
+        }
+    }
+    return 0;
+}
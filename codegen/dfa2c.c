@@ -0,0 +1,355 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "../dfa/read_dfa_from_file.h"
+#include "../dfa/compiled_dfa.h"
+
+// Automata with more states than this, or with a state whose letters lead to more destinations than this,
+// get a transition table by default rather than a state machine of jumps. Jumps are faster when runs
+// mostly stay on a few predictable paths, as in keyword search, and a table when they move around unpredictably.
+#define MAX_SWITCH_STATES 256
+#define MAX_SWITCH_DESTINATIONS 4
+
+// Number of values per line in the generated arrays
+#define VALUES_PER_LINE 16
+
+typedef enum Matcher_Kind {
+    SWITCH_MATCHER, // every state is a label that tests the next letter and jumps to the label of the next state
+    TABLE_MATCHER   // a loop over a static transition table of letter classes
+} Matcher_Kind;
+
+// Helper functions declarations
+
+int is_identifier(const char *name);
+
+// Returns 1 if the state is final and all its transitions lead back to it, so every input that reaches it is ACCEPTED
+int is_accepting_sink(const struct Compiled_DFA *compiled, unsigned state_id);
+
+// Sets the number of ranges of consecutive letters that lead from the origin state to every destination
+// and returns the number of destinations reached
+unsigned count_letter_ranges(const struct Compiled_DFA *compiled, unsigned origin, unsigned *ranges_to);
+
+// Returns 1 if the automaton should become a state machine of jumps by default
+int is_suited_to_jumps(const struct Compiled_DFA *compiled);
+
+// Prints the comment and the includes that open every generated file
+void print_preamble(FILE *output, const char *filename);
+
+void print_header(FILE *output, const char *filename, const char *name);
+
+// Prints the statement that moves the matcher to the destination state
+void print_jump(FILE *output, const struct Compiled_DFA *compiled, unsigned destination, const char *indentation);
+
+// Prints the condition on the letter that holds for the letters leading from the origin state to the destination
+void print_letter_condition(FILE *output, const struct Compiled_DFA *compiled, unsigned origin, unsigned destination);
+
+void print_switch_matcher(FILE *output, const char *filename, const struct Compiled_DFA *compiled, const char *name);
+
+void print_table_matcher(FILE *output, const char *filename, const struct Compiled_DFA *compiled, const char *name);
+
+void print_usage(const char *program);
+
+int main(int argc, char *argv[]) {
+    int header_only = 0;
+    int kind = -1;
+    int first_argument = 1;
+    for (; first_argument < argc && argv[first_argument][0] == '-'; first_argument++) {
+        if (strcmp(argv[first_argument], "--header") == 0) {
+            header_only = 1;
+        } else if (strcmp(argv[first_argument], "--switch") == 0) {
+            kind = SWITCH_MATCHER;
+        } else if (strcmp(argv[first_argument], "--table") == 0) {
+            kind = TABLE_MATCHER;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (argc - first_argument != 3 || !is_identifier(argv[first_argument + 1])) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char *filename = argv[first_argument];
+    const char *name = argv[first_argument + 1];
+    const char *output_filename = argv[first_argument + 2];
+
+    struct DFA *dfa = read_dfa_from_file(filename, 1);
+    if (dfa == NULL) {
+        return 1;
+    }
+
+    // Minimization leaves a single dead state, the garbage state, so a matcher can stop as soon as it gets there
+    struct DFA *minimal = minimize_DFA(dfa);
+    delete_DFA(dfa);
+    const struct Compiled_DFA *compiled = get_compiled_DFA(minimal);
+    if (kind < 0) {
+        kind = is_suited_to_jumps(compiled) ? SWITCH_MATCHER : TABLE_MATCHER;
+    }
+
+    FILE *output = fopen(output_filename, "w");
+    if (output == NULL) {
+        fprintf(stderr, "Could not open \"%s\" for writing\n", output_filename);
+        delete_DFA(minimal);
+        return 1;
+    }
+    if (header_only) {
+        print_header(output, filename, name);
+    } else if (kind == SWITCH_MATCHER) {
+        print_switch_matcher(output, filename, compiled, name);
+    } else {
+        print_table_matcher(output, filename, compiled, name);
+    }
+    int is_written = fclose(output) == 0;
+    delete_DFA(minimal);
+    if (!is_written) {
+        fprintf(stderr, "Could not write \"%s\"\n", output_filename);
+        return 1;
+    }
+    return 0;
+}
+
+// Helper functions definitions
+
+int is_identifier(const char *name) {
+    if (!isalpha((unsigned char) name[0]) && name[0] != '_') {
+        return 0;
+    }
+    for (; *name != '\0'; name++) {
+        if (!isalnum((unsigned char) *name) && *name != '_') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int is_accepting_sink(const struct Compiled_DFA *compiled, unsigned state_id) {
+    if (!is_compiled_state_final(compiled, state_id)) {
+        return 0;
+    }
+    for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+        if (get_compiled_class_transition(compiled, state_id, c) != state_id) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+unsigned count_letter_ranges(const struct Compiled_DFA *compiled, unsigned origin, unsigned *ranges_to) {
+    unsigned destinations = 0;
+    memset(ranges_to, 0, compiled->number_of_states * sizeof(unsigned));
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        unsigned destination = get_compiled_transition(compiled, origin, (unsigned char) letter);
+        if (letter == 0 || get_compiled_transition(compiled, origin, (unsigned char) (letter - 1)) != destination) {
+            destinations += ranges_to[destination] == 0;
+            ranges_to[destination]++;
+        }
+    }
+    return destinations;
+}
+
+int is_suited_to_jumps(const struct Compiled_DFA *compiled) {
+    if (compiled->number_of_states > MAX_SWITCH_STATES) {
+        return 0;
+    }
+    unsigned ranges_to[MAX_SWITCH_STATES];
+    for (unsigned state = 0; state < compiled->garbage_state; state++) {
+        if (count_letter_ranges(compiled, state, ranges_to) > MAX_SWITCH_DESTINATIONS) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void print_preamble(FILE *output, const char *filename) {
+    fprintf(output, "// Generated by dfa2c from \"%s\". Do not edit.\n", filename);
+    fprintf(output, "#include <stddef.h>\n\n");
+}
+
+void print_header(FILE *output, const char *filename, const char *name) {
+    print_preamble(output, filename);
+    fprintf(output, "// Returns 1 if the input is ACCEPTED by the DFA, 0 if it is REJECTED\n");
+    fprintf(output, "int %s(const char *input, size_t length);\n", name);
+}
+
+void print_jump(FILE *output, const struct Compiled_DFA *compiled, unsigned destination, const char *indentation) {
+    if (destination == compiled->garbage_state) {
+        fprintf(output, "%sreturn 0;\n", indentation);
+    } else if (is_accepting_sink(compiled, destination)) {
+        fprintf(output, "%sreturn 1;\n", indentation);
+    } else {
+        fprintf(output, "%sgoto state_%u;\n", indentation, destination);
+    }
+}
+
+void print_letter_condition(FILE *output, const struct Compiled_DFA *compiled, unsigned origin, unsigned destination) {
+    int is_first = 1;
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        if (get_compiled_transition(compiled, origin, (unsigned char) letter) != destination) {
+            continue;
+        }
+        unsigned last = letter;
+        while (last + 1 < DFA_ALPHABET_SIZE && get_compiled_transition(compiled, origin, (unsigned char) (last + 1)) == destination) {
+            last++;
+        }
+        fprintf(output, is_first ? "" : " || ");
+        if (last == letter) {
+            fprintf(output, "letter == %u", letter);
+        } else if (letter == 0) {
+            fprintf(output, "letter <= %u", last);
+        } else if (last == DFA_ALPHABET_SIZE - 1) {
+            fprintf(output, "letter >= %u", letter);
+        } else {
+            fprintf(output, "(letter >= %u && letter <= %u)", letter, last);
+        }
+        is_first = 0;
+        letter = last;
+    }
+}
+
+void print_switch_matcher(FILE *output, const char *filename, const struct Compiled_DFA *compiled, const char *name) {
+    unsigned number_of_states = compiled->number_of_states;
+
+    // A state gets a label only if a jump leads to it
+    unsigned char *is_jumped_to = (unsigned char*) calloc(number_of_states, 1);
+    for (unsigned state = 0; state < compiled->garbage_state; state++) {
+        for (unsigned c = 0; c < compiled->number_of_classes && !is_accepting_sink(compiled, state); c++) {
+            is_jumped_to[get_compiled_class_transition(compiled, state, c)] = 1;
+        }
+    }
+
+    print_preamble(output, filename);
+    fprintf(output, "int %s(const char *input, size_t length) {\n", name);
+    if (is_accepting_sink(compiled, 0) || compiled->garbage_state == 0) {
+        fprintf(output, "    (void) input;\n    (void) length;\n");
+        print_jump(output, compiled, 0, "    ");
+        fprintf(output, "}\n");
+        free(is_jumped_to);
+        return;
+    }
+    // Accepting sinks are left by returning, so they are never reached
+    unsigned char *is_printed = (unsigned char*) calloc(number_of_states, 1);
+    for (unsigned state = 0; state < compiled->garbage_state; state++) {
+        is_printed[state] = !is_accepting_sink(compiled, state) && (state == 0 || is_jumped_to[state]);
+    }
+
+    // The letter is kept in a variable only if a state leads to several destinations, so that it is tested
+    unsigned *ranges_to = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    int is_letter_tested = 0;
+    for (unsigned state = 0; state < compiled->garbage_state; state++) {
+        if (is_printed[state] && count_letter_ranges(compiled, state, ranges_to) > 1) {
+            is_letter_tested = 1;
+        }
+    }
+
+    fprintf(output, "    const unsigned char *next = (const unsigned char*) input;\n");
+    fprintf(output, "    const unsigned char *end = next + length;\n");
+    if (is_letter_tested) {
+        fprintf(output, "    unsigned letter;\n");
+    }
+
+    for (unsigned state = 0; state < compiled->garbage_state; state++) {
+        if (!is_printed[state]) {
+            continue;
+        }
+        if (is_jumped_to[state]) {
+            fprintf(output, "state_%u:\n", state);
+        }
+        fprintf(output, "    if (next == end) {\n        return %d;\n    }\n", is_compiled_state_final(compiled, state));
+        if (count_letter_ranges(compiled, state, ranges_to) > 1) {
+            fprintf(output, "    letter = *next++;\n");
+        } else {
+            fprintf(output, "    next++;\n");
+        }
+
+        // The destination whose letters take the most ranges is left for last without a test, preferring a state
+        // to the garbage state on ties, and the others are tested from the one with the fewest ranges up
+        unsigned last_destination = compiled->garbage_state;
+        for (unsigned d = 0; d < compiled->garbage_state; d++) {
+            if (ranges_to[d] >= ranges_to[last_destination]) {
+                last_destination = d;
+            }
+        }
+        ranges_to[last_destination] = 0;
+        for (unsigned ranges = 1; ranges <= DFA_ALPHABET_SIZE / 2; ranges++) {
+            for (unsigned d = number_of_states; d-- > 0;) {
+                if (ranges_to[d] != ranges) {
+                    continue;
+                }
+                fprintf(output, "    if (");
+                print_letter_condition(output, compiled, state, d);
+                fprintf(output, ") {\n");
+                print_jump(output, compiled, d, "        ");
+                fprintf(output, "    }\n");
+            }
+        }
+        print_jump(output, compiled, last_destination, "    ");
+    }
+    fprintf(output, "}\n");
+    free(ranges_to);
+    free(is_printed);
+    free(is_jumped_to);
+}
+
+void print_table_matcher(FILE *output, const char *filename, const struct Compiled_DFA *compiled, const char *name) {
+    const char *state_type =
+        compiled->number_of_states <= 0x100 ? "unsigned char" :
+        compiled->number_of_states <= 0x10000 ? "unsigned short" : "unsigned";
+
+    print_preamble(output, filename);
+    fprintf(output, "static const unsigned char %s_letter_classes[256] = {", name);
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        fprintf(output, "%s%u,", letter % VALUES_PER_LINE == 0 ? "\n    " : " ", compiled->letter_classes[letter]);
+    }
+    fprintf(output, "\n};\n\n");
+
+    fprintf(
+        output, "static const %s %s_transitions[%u][%u] = {\n",
+        state_type, name, compiled->number_of_states, compiled->number_of_classes
+    );
+    for (unsigned state = 0; state < compiled->number_of_states; state++) {
+        fprintf(output, "    {");
+        for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+            if (c > 0) {
+                fprintf(output, c % VALUES_PER_LINE == 0 ? ",\n     " : ", ");
+            }
+            fprintf(output, "%u", get_compiled_class_transition(compiled, state, c));
+        }
+        fprintf(output, "},\n");
+    }
+    fprintf(output, "};\n\n");
+
+    unsigned final_bytes = (compiled->number_of_states + 7) / 8;
+    fprintf(output, "static const unsigned char %s_final_states[%u] = {", name, final_bytes);
+    for (unsigned i = 0; i < final_bytes; i++) {
+        unsigned byte = 0;
+        for (unsigned bit = 0; bit < 8 && 8 * i + bit < compiled->number_of_states; bit++) {
+            byte |= (unsigned) is_compiled_state_final(compiled, 8 * i + bit) << bit;
+        }
+        fprintf(output, "%s%u,", i % VALUES_PER_LINE == 0 ? "\n    " : " ", byte);
+    }
+    fprintf(output, "\n};\n\n");
+
+    fprintf(output, "int %s(const char *input, size_t length) {\n", name);
+    fprintf(output, "    const unsigned char *letters = (const unsigned char*) input;\n");
+    fprintf(output, "    unsigned state = 0;\n");
+    fprintf(output, "    for (size_t i = 0; i < length; i++) {\n");
+    fprintf(output, "        state = %s_transitions[state][%s_letter_classes[letters[i]]];\n", name, name);
+    fprintf(output, "        if (state == %u) {\n            return 0;\n        }\n", compiled->garbage_state);
+    fprintf(output, "    }\n");
+    fprintf(output, "    return (%s_final_states[state / 8] >> (state %% 8)) & 1;\n", name);
+    fprintf(output, "}\n");
+}
+
+void print_usage(const char *program) {
+    fprintf(
+        stderr,
+        "Usage: %s [--switch | --table] [--header] <DFA file> <function name> <output file>\n"
+        "  Writes a C source file that defines int <function name>(const char *input, size_t length), a matcher\n"
+        "  of the DFA that returns 1 if the input is ACCEPTED and 0 if it is REJECTED. Automata with up to %d states,\n"
+        "  whose states lead to at most %d destinations each, become a state machine of jumps (--switch) by default\n"
+        "  and others a loop over a transition table (--table).\n"
+        "  With --header the file only declares the function.\n",
+        program, MAX_SWITCH_STATES, MAX_SWITCH_DESTINATIONS
+    );
+}
@@ -0,0 +1,217 @@
+#include <stdlib.h>
+#include <string.h>
+#include "compiled_dfa.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DFA_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// Helper functions declarations
+
+// Marks the states from which no final state can be reached
+void mark_dead_states(Compiled_DFA *compiled);
+
+// Finds the letters that keep every live state in itself and prepares the sets for the skipping kernels
+void find_self_loops(Compiled_DFA *compiled);
+
+size_t skip_self_loops_scalar(const Self_Loop_Set *set, const unsigned char *letters, size_t position, size_t length);
+
+#ifdef DFA_X86_KERNELS
+size_t skip_self_loops_ssse3(const Self_Loop_Set *set, const unsigned char *letters, size_t position, size_t length);
+size_t skip_self_loops_avx2(const Self_Loop_Set *set, const unsigned char *letters, size_t position, size_t length);
+#endif
+
+// Definitions of functions from "compiled_dfa.h"
+
+void prepare_state_flags(Compiled_DFA *compiled) {
+    compiled->state_flags = (unsigned char*) allocate_DFA_memory(&compiled->allocator, compiled->number_of_states, COMPILED_DFA_ALIGNMENT);
+    mark_dead_states(compiled);
+    find_self_loops(compiled);
+    compiled->skip_self_loops = select_self_loop_kernel();
+}
+
+Self_Loop_Kernel select_self_loop_kernel() {
+#ifdef DFA_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return skip_self_loops_avx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return skip_self_loops_ssse3;
+    }
+#endif
+    return skip_self_loops_scalar;
+}
+
+int is_compiled_state_dead(const Compiled_DFA *compiled, unsigned state_id) {
+    return compiled->state_flags[state_id] & DFA_STATE_DEAD ? 1 : 0;
+}
+
+void add_letter_to_self_loop_set(Self_Loop_Set *set, unsigned char letter) {
+    // The mask for the low nibble holds one bit per value of the high nibble (modulo 8).
+    // Letters below 128 use the first 16 masks, the others use the last 16.
+    unsigned low_nibble = letter & 0x0F, high_nibble = letter >> 4;
+    set->masks[(letter < 128 ? 0 : 16) + low_nibble] |= (unsigned char) (1u << (high_nibble & 7));
+    set->bitmap[letter / 64] |= 1ULL << (letter % 64);
+}
+
+// Helper functions definitions
+
+void mark_dead_states(Compiled_DFA *compiled) {
+    unsigned n = compiled->number_of_states;
+    size_t cells = (size_t) n * compiled->number_of_classes;
+
+    // Inverse transitions: predecessors[start[q] .. start[q + 1]) lead to q
+    unsigned *start = (unsigned*) calloc(n + 1, sizeof(unsigned));
+    unsigned *predecessors = (unsigned*) malloc((cells + 1) * sizeof(unsigned));
+    for (unsigned p = 0; p < n; p++) {
+        for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+            start[get_compiled_class_transition(compiled, p, c) + 1]++;
+        }
+    }
+    for (unsigned q = 0; q < n; q++) {
+        start[q + 1] += start[q];
+    }
+    unsigned *fill = (unsigned*) malloc((n + 1) * sizeof(unsigned));
+    memcpy(fill, start, (n + 1) * sizeof(unsigned));
+    for (unsigned p = 0; p < n; p++) {
+        for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+            predecessors[fill[get_compiled_class_transition(compiled, p, c)]++] = p;
+        }
+    }
+
+    // Every state that reaches a final state is found by walking backwards from the final states
+    unsigned char *alive = (unsigned char*) calloc(n, sizeof(unsigned char));
+    unsigned *queue = (unsigned*) malloc(n * sizeof(unsigned));
+    unsigned queue_size = 0;
+    for (unsigned s = 0; s < n; s++) {
+        if (is_compiled_state_final(compiled, s)) {
+            alive[s] = 1;
+            queue[queue_size++] = s;
+        }
+    }
+    for (unsigned head = 0; head < queue_size; head++) {
+        unsigned q = queue[head];
+        for (unsigned k = start[q]; k < start[q + 1]; k++) {
+            if (!alive[predecessors[k]]) {
+                alive[predecessors[k]] = 1;
+                queue[queue_size++] = predecessors[k];
+            }
+        }
+    }
+
+    for (unsigned s = 0; s < n; s++) {
+        if (!alive[s]) {
+            compiled->state_flags[s] |= DFA_STATE_DEAD;
+        }
+    }
+
+    free(start);
+    free(predecessors);
+    free(fill);
+    free(alive);
+    free(queue);
+}
+
+void find_self_loops(Compiled_DFA *compiled) {
+    unsigned n = compiled->number_of_states;
+    compiled->self_loop_index = (unsigned*) allocate_DFA_memory(&compiled->allocator, (size_t) n * sizeof(unsigned), COMPILED_DFA_ALIGNMENT);
+
+    compiled->number_of_self_loops = 0;
+    for (unsigned s = 0; s < n; s++) {
+        if (compiled->state_flags[s] & DFA_STATE_DEAD) {
+            continue;
+        }
+        for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+            if (get_compiled_class_transition(compiled, s, c) == s) {
+                compiled->state_flags[s] |= DFA_STATE_ACCELERATED;
+                compiled->self_loop_index[s] = compiled->number_of_self_loops++;
+                break;
+            }
+        }
+    }
+
+    compiled->self_loops = (Self_Loop_Set*) allocate_DFA_memory(
+        &compiled->allocator, (compiled->number_of_self_loops + 1) * sizeof(Self_Loop_Set), COMPILED_DFA_ALIGNMENT
+    );
+    for (unsigned s = 0; s < n; s++) {
+        if (!(compiled->state_flags[s] & DFA_STATE_ACCELERATED)) {
+            continue;
+        }
+        Self_Loop_Set *set = &compiled->self_loops[compiled->self_loop_index[s]];
+        for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+            if (get_compiled_transition(compiled, s, (unsigned char) letter) == s) {
+                add_letter_to_self_loop_set(set, (unsigned char) letter);
+            }
+        }
+    }
+}
+
+size_t skip_self_loops_scalar(const Self_Loop_Set *set, const unsigned char *letters, size_t position, size_t length) {
+    while (position < length && (set->bitmap[letters[position] / 64] >> (letters[position] % 64)) & 1) {
+        position++;
+    }
+    return position;
+}
+
+#ifdef DFA_X86_KERNELS
+
+// Tests 16 letters at once: the low nibble of every letter selects a mask with pshufb and
+// the high nibble selects the bit in it
+__attribute__((target("ssse3")))
+size_t skip_self_loops_ssse3(const Self_Loop_Set *set, const unsigned char *letters, size_t position, size_t length) {
+    const __m128i low_masks = _mm_loadu_si128((const __m128i*) set->masks);
+    const __m128i high_masks = _mm_loadu_si128((const __m128i*) (set->masks + 16));
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i high_bit = _mm_set1_epi8(-128);
+
+    while (position + 16 <= length) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (letters + position));
+        // pshufb yields 0 for indices with the top bit set, which splits letters below and above 128
+        __m128i masks = _mm_or_si128(
+            _mm_shuffle_epi8(low_masks, v),
+            _mm_shuffle_epi8(high_masks, _mm_xor_si128(v, high_bit))
+        );
+        __m128i bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        __m128i outside = _mm_cmpeq_epi8(_mm_and_si128(masks, bit), _mm_setzero_si128());
+        unsigned mask = (unsigned) _mm_movemask_epi8(outside);
+        if (mask != 0) {
+            return position + __builtin_ctz(mask);
+        }
+        position += 16;
+    }
+    return skip_self_loops_scalar(set, letters, position, length);
+}
+
+// Same as the SSSE3 kernel, but 32 letters at once
+__attribute__((target("avx2")))
+size_t skip_self_loops_avx2(const Self_Loop_Set *set, const unsigned char *letters, size_t position, size_t length) {
+    const __m256i low_masks = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) set->masks));
+    const __m256i high_masks = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) (set->masks + 16)));
+    const __m256i bits = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+    );
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i high_bit = _mm256_set1_epi8(-128);
+
+    while (position + 32 <= length) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (letters + position));
+        __m256i masks = _mm256_or_si256(
+            _mm256_shuffle_epi8(low_masks, v),
+            _mm256_shuffle_epi8(high_masks, _mm256_xor_si256(v, high_bit))
+        );
+        __m256i bit = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        __m256i outside = _mm256_cmpeq_epi8(_mm256_and_si256(masks, bit), _mm256_setzero_si256());
+        unsigned mask = (unsigned) _mm256_movemask_epi8(outside);
+        if (mask != 0) {
+            return position + __builtin_ctz(mask);
+        }
+        position += 32;
+    }
+    return skip_self_loops_ssse3(set, letters, position, length);
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include "compiled_dfa.h"
+
+// Number of inputs that are advanced in lockstep
+#define DFA_BATCH_LANES 8
+
+// Batch loops specialized for every state ID width.
+// Every lane holds one input. All lanes are advanced together for as many letters as the shortest of them has left,
+// so the table lookups of different lanes are independent and can be in flight at the same time.
+// Once a lane's input is done its result is written and the lane takes the next input. When there are no inputs
+// left to refill the lanes, the remaining ones are finished one by one.
+#define DEFINE_BATCH_LOOP(NAME, STATE_ID_TYPE)                                                      \
+static void NAME(const Compiled_DFA *compiled, const char* const inputs[], const unsigned lengths[], unsigned count, int results[]) { \
+    const STATE_ID_TYPE *transitions = (const STATE_ID_TYPE*) compiled->transitions;               \
+    const unsigned char *letter_classes = compiled->letter_classes;                                 \
+    size_t number_of_classes = compiled->number_of_classes;                                         \
+                                                                                                    \
+    const unsigned char *letters[DFA_BATCH_LANES];                                                  \
+    unsigned remaining[DFA_BATCH_LANES], input_index[DFA_BATCH_LANES];                              \
+    size_t state[DFA_BATCH_LANES];                                                                  \
+    unsigned next_input = 0;                                                                        \
+                                                                                                    \
+    for (unsigned lane = 0; lane < DFA_BATCH_LANES; lane++) {                                       \
+        input_index[lane] = next_input;                                                             \
+        letters[lane] = (const unsigned char*) inputs[next_input];                                  \
+        remaining[lane] = lengths[next_input];                                                      \
+        state[lane] = 0;                                                                            \
+        next_input++;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    while (1) {                                                                                     \
+        unsigned steps = remaining[0];                                                              \
+        for (unsigned lane = 1; lane < DFA_BATCH_LANES; lane++) {                                   \
+            steps = remaining[lane] < steps ? remaining[lane] : steps;                              \
+        }                                                                                           \
+                                                                                                    \
+        for (unsigned i = 0; i < steps; i++) {                                                      \
+            for (unsigned lane = 0; lane < DFA_BATCH_LANES; lane++) {                               \
+                state[lane] = transitions[state[lane] * number_of_classes + letter_classes[letters[lane][i]]]; \
+            }                                                                                       \
+        }                                                                                           \
+                                                                                                    \
+        int lanes_full = 1;                                                                         \
+        for (unsigned lane = 0; lane < DFA_BATCH_LANES; lane++) {                                   \
+            letters[lane] += steps;                                                                 \
+            remaining[lane] -= steps;                                                               \
+            if (remaining[lane] > 0) {                                                              \
+                continue;                                                                           \
+            }                                                                                       \
+            results[input_index[lane]] = is_compiled_state_final(compiled, (unsigned) state[lane]); \
+            if (next_input == count) {                                                              \
+                lanes_full = 0;                                                                     \
+                continue;                                                                           \
+            }                                                                                       \
+            input_index[lane] = next_input;                                                         \
+            letters[lane] = (const unsigned char*) inputs[next_input];                              \
+            remaining[lane] = lengths[next_input];                                                  \
+            state[lane] = 0;                                                                        \
+            next_input++;                                                                           \
+        }                                                                                           \
+                                                                                                    \
+        if (!lanes_full) {                                                                          \
+            break;                                                                                  \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    /* Finish the lanes that are still running */                                                  \
+    for (unsigned lane = 0; lane < DFA_BATCH_LANES; lane++) {                                       \
+        if (remaining[lane] > 0) {                                                                  \
+            unsigned final_state = advance_compiled_DFA(compiled, (unsigned) state[lane], (const char*) letters[lane], remaining[lane]); \
+            results[input_index[lane]] = is_compiled_state_final(compiled, final_state);            \
+        }                                                                                           \
+    }                                                                                               \
+}
+
+DEFINE_BATCH_LOOP(run_batch_8, unsigned char)
+DEFINE_BATCH_LOOP(run_batch_16, unsigned short)
+DEFINE_BATCH_LOOP(run_batch_32, unsigned)
+
+// Definitions of functions from "dfa.h"
+
+void run_DFA_batch(struct DFA *dfa, const char* const inputs[], const unsigned lengths[], unsigned count, int results[]) {
+    const Compiled_DFA *compiled = get_compiled_DFA(dfa);
+
+    // Too few inputs to fill the lanes
+    if (count < DFA_BATCH_LANES) {
+        for (unsigned i = 0; i < count; i++) {
+            results[i] = run_compiled_DFA(compiled, inputs[i], lengths[i]);
+        }
+        return;
+    }
+
+    switch (compiled->state_id_width) {
+    case 1:
+        run_batch_8(compiled, inputs, lengths, count, results);
+        break;
+    case 2:
+        run_batch_16(compiled, inputs, lengths, count, results);
+        break;
+    default:
+        run_batch_32(compiled, inputs, lengths, count, results);
+        break;
+    }
+}
@@ -0,0 +1,368 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "compiled_dfa.h"
+
+// Helper functions declarations
+
+// Allocates the structure of a compiled DFA from the allocator (which may be NULL)
+Compiled_DFA *allocate_compiled_DFA(const DFA_Allocator *allocator);
+
+// Splits the alphabet into classes of letters that lead to the same destination in every state.
+// Fills the class of every letter and returns the number of classes.
+unsigned compute_letter_classes(
+    unsigned number_of_states, unsigned garbage_state,
+    const DFA_Edge *edges, unsigned edge_count,
+    unsigned char *letter_classes
+);
+
+int compare_class_edges(const void *a, const void *b);
+
+// Returns the size in bytes of the narrowest state ID type that fits the given number of states
+unsigned choose_state_id_width(unsigned number_of_states);
+
+// Writes a state ID into the transition table cell
+void set_table_cell(Compiled_DFA *compiled, size_t cell, unsigned state_id);
+
+// Fills the final states bitset and the state flags of a compiled DFA whose transition table is filled in
+void finish_compiled_DFA(Compiled_DFA *compiled, const unsigned *final_states, unsigned final_states_count);
+
+// Run loops specialized for every state ID width.
+// The flags of the reached state are checked after every letter: a dead state ends the run, and when an
+// accelerated state has just looped on itself the rest of the run of such letters is skipped at once.
+#define DEFINE_ADVANCE_LOOP(NAME, STATE_ID_TYPE)                                                   \
+static unsigned NAME(const Compiled_DFA *compiled, unsigned state_id, const unsigned char *letters, size_t length) { \
+    const STATE_ID_TYPE *transitions = (const STATE_ID_TYPE*) compiled->transitions;              \
+    const unsigned char *letter_classes = compiled->letter_classes;                                \
+    const unsigned char *state_flags = compiled->state_flags;                                      \
+    size_t number_of_classes = compiled->number_of_classes;                                        \
+    size_t current_state_id = state_id;                                                            \
+    size_t i = 0;                                                                                  \
+    while (i < length) {                                                                           \
+        size_t next_state_id = transitions[current_state_id * number_of_classes + letter_classes[letters[i++]]]; \
+        if (state_flags[next_state_id]) {                                                          \
+            if (state_flags[next_state_id] & DFA_STATE_DEAD) {                                     \
+                return (unsigned) next_state_id;                                                   \
+            }                                                                                      \
+            if (next_state_id == current_state_id) {                                               \
+                const Self_Loop_Set *set = &compiled->self_loops[compiled->self_loop_index[next_state_id]]; \
+                i = compiled->skip_self_loops(set, letters, i, length);                            \
+            }                                                                                      \
+        }                                                                                          \
+        current_state_id = next_state_id;                                                          \
+    }                                                                                              \
+    return (unsigned) current_state_id;                                                            \
+}
+
+DEFINE_ADVANCE_LOOP(advance_8, unsigned char)
+DEFINE_ADVANCE_LOOP(advance_16, unsigned short)
+DEFINE_ADVANCE_LOOP(advance_32, unsigned)
+
+// Definitions of functions from "compiled_dfa.h"
+
+Compiled_DFA *build_compiled_DFA(
+    unsigned number_of_states,
+    const DFA_Edge *edges, unsigned edge_count,
+    const unsigned *final_states, unsigned final_states_count
+) {
+    return build_compiled_DFA_with_allocator(number_of_states, edges, edge_count, final_states, final_states_count, NULL);
+}
+
+Compiled_DFA *build_compiled_DFA_with_allocator(
+    unsigned number_of_states,
+    const DFA_Edge *edges, unsigned edge_count,
+    const unsigned *final_states, unsigned final_states_count,
+    const DFA_Allocator *allocator
+) {
+    Compiled_DFA *compiled = allocate_compiled_DFA(allocator);
+    compiled->number_of_states = number_of_states + 1;
+    compiled->garbage_state = number_of_states;
+    compiled->number_of_classes = compute_letter_classes(
+        compiled->number_of_states, compiled->garbage_state, edges, edge_count, compiled->letter_classes
+    );
+
+    compiled->state_id_width = choose_state_id_width(compiled->number_of_states);
+
+    size_t cells = (size_t) compiled->number_of_states * compiled->number_of_classes;
+    compiled->transitions = allocate_DFA_memory(&compiled->allocator, cells * compiled->state_id_width, COMPILED_DFA_ALIGNMENT);
+    for (size_t i = 0; i < cells; i++) {
+        set_table_cell(compiled, i, compiled->garbage_state);
+    }
+
+    // All letters of a class lead to the same destination, so any of them can fill the cell
+    for (unsigned i = 0; i < edge_count; i++) {
+        DFA_Edge e = edges[i];
+        size_t row = (size_t) e.origin * compiled->number_of_classes;
+        set_table_cell(compiled, row + compiled->letter_classes[e.letter], e.destination);
+    }
+
+    finish_compiled_DFA(compiled, final_states, final_states_count);
+    return compiled;
+}
+
+Compiled_DFA *build_compiled_DFA_from_classes(
+    unsigned number_of_states,
+    const unsigned char *letter_classes, unsigned number_of_classes,
+    const unsigned *class_transitions,
+    const unsigned *final_states, unsigned final_states_count,
+    const DFA_Allocator *allocator
+) {
+    Compiled_DFA *compiled = allocate_compiled_DFA(allocator);
+    compiled->number_of_states = number_of_states + 1;
+    compiled->garbage_state = number_of_states;
+    memcpy(compiled->letter_classes, letter_classes, DFA_ALPHABET_SIZE);
+    compiled->number_of_classes = number_of_classes;
+
+    compiled->state_id_width = choose_state_id_width(compiled->number_of_states);
+    compiled->transitions = allocate_DFA_memory(
+        &compiled->allocator, (size_t) compiled->number_of_states * number_of_classes * compiled->state_id_width, COMPILED_DFA_ALIGNMENT
+    );
+    size_t cells = (size_t) number_of_states * number_of_classes;
+    for (size_t i = 0; i < cells; i++) {
+        set_table_cell(compiled, i, class_transitions[i]);
+    }
+    for (unsigned c = 0; c < number_of_classes; c++) {
+        set_table_cell(compiled, cells + c, compiled->garbage_state);
+    }
+
+    finish_compiled_DFA(compiled, final_states, final_states_count);
+    return compiled;
+}
+
+Compiled_DFA *compile_DFA(const struct DFA *dfa) {
+    unsigned number_of_states = get_number_of_states(dfa);
+    unsigned garbage_state = number_of_states - 1;
+
+    // Only transitions that do not lead to the garbage state need to be listed
+    unsigned edge_count = 0, edge_capacity = 64;
+    DFA_Edge *edges = (DFA_Edge*) malloc(edge_capacity * sizeof(DFA_Edge));
+    unsigned final_states_count = 0;
+    unsigned *final_states = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+
+    for (unsigned state_id = 0; state_id < number_of_states; state_id++) {
+        if (is_final_state(dfa, state_id)) {
+            final_states[final_states_count++] = state_id;
+        }
+
+        // Sparse states give their transitions as runs of letters, so their runs to the garbage state are skipped at once
+        for (unsigned first = 0; first < DFA_ALPHABET_SIZE;) {
+            unsigned destination;
+            unsigned last = get_transition_run(dfa, state_id, (unsigned char) first, &destination);
+            for (unsigned letter = first; letter <= last && destination != garbage_state; letter++) {
+                if (edge_count == edge_capacity) {
+                    edge_capacity *= 2;
+                    edges = (DFA_Edge*) realloc(edges, edge_capacity * sizeof(DFA_Edge));
+                }
+                edges[edge_count].origin = state_id;
+                edges[edge_count].destination = destination;
+                edges[edge_count].letter = (unsigned char) letter;
+                edge_count++;
+            }
+            first = last + 1;
+        }
+    }
+
+    Compiled_DFA *compiled = build_compiled_DFA_with_allocator(
+        garbage_state, edges, edge_count, final_states, final_states_count, get_DFA_allocator(dfa)
+    );
+    free(edges);
+    free(final_states);
+    return compiled;
+}
+
+void delete_compiled_DFA(Compiled_DFA *compiled) {
+    if (compiled == NULL) {
+        return;
+    }
+    DFA_Allocator allocator = compiled->allocator;
+    if (compiled->mapping != NULL) {
+        munmap(compiled->mapping, compiled->mapping_size);
+    } else {
+        release_DFA_memory(&allocator, compiled->transitions);
+        release_DFA_memory(&allocator, compiled->final_states);
+        release_DFA_memory(&allocator, compiled->state_flags);
+        release_DFA_memory(&allocator, compiled->self_loop_index);
+        release_DFA_memory(&allocator, compiled->self_loops);
+    }
+    release_DFA_memory(&allocator, compiled);
+}
+
+int run_compiled_DFA(const Compiled_DFA *compiled, const char *input, unsigned length) {
+    return is_compiled_state_final(compiled, advance_compiled_DFA(compiled, 0, input, length));
+}
+
+unsigned advance_compiled_DFA(const Compiled_DFA *compiled, unsigned state_id, const char *input, size_t length) {
+    const unsigned char *letters = (const unsigned char*) input;
+    switch (compiled->state_id_width) {
+    case 1:
+        return advance_8(compiled, state_id, letters, length);
+    case 2:
+        return advance_16(compiled, state_id, letters, length);
+    default:
+        return advance_32(compiled, state_id, letters, length);
+    }
+}
+
+size_t get_compiled_table_size(const Compiled_DFA *compiled) {
+    return (size_t) compiled->number_of_states * compiled->number_of_classes * compiled->state_id_width;
+}
+
+unsigned get_compiled_transition(const Compiled_DFA *compiled, unsigned origin, unsigned char letter) {
+    return get_compiled_class_transition(compiled, origin, compiled->letter_classes[letter]);
+}
+
+unsigned get_compiled_class_transition(const Compiled_DFA *compiled, unsigned origin, unsigned letter_class) {
+    size_t cell = (size_t) origin * compiled->number_of_classes + letter_class;
+    switch (compiled->state_id_width) {
+    case 1:
+        return ((const unsigned char*) compiled->transitions)[cell];
+    case 2:
+        return ((const unsigned short*) compiled->transitions)[cell];
+    default:
+        return ((const unsigned*) compiled->transitions)[cell];
+    }
+}
+
+int is_compiled_state_final(const Compiled_DFA *compiled, unsigned state_id) {
+    return (compiled->final_states[state_id / 64] >> (state_id % 64)) & 1 ? 1 : 0;
+}
+
+// Helper functions definitions
+
+Compiled_DFA *allocate_compiled_DFA(const DFA_Allocator *allocator) {
+    Compiled_DFA *compiled = (Compiled_DFA*) allocate_DFA_memory(allocator, sizeof(Compiled_DFA), COMPILED_DFA_ALIGNMENT);
+    if (allocator != NULL) {
+        compiled->allocator = *allocator;
+    }
+    compiled->mapping = NULL;
+    compiled->mapping_size = 0;
+    return compiled;
+}
+
+unsigned choose_state_id_width(unsigned number_of_states) {
+    if (number_of_states <= 1u << 8) {
+        return 1;
+    }
+    if (number_of_states <= 1u << 16) {
+        return 2;
+    }
+    return 4;
+}
+
+void set_table_cell(Compiled_DFA *compiled, size_t cell, unsigned state_id) {
+    switch (compiled->state_id_width) {
+    case 1:
+        ((unsigned char*) compiled->transitions)[cell] = (unsigned char) state_id;
+        break;
+    case 2:
+        ((unsigned short*) compiled->transitions)[cell] = (unsigned short) state_id;
+        break;
+    default:
+        ((unsigned*) compiled->transitions)[cell] = state_id;
+        break;
+    }
+}
+
+void finish_compiled_DFA(Compiled_DFA *compiled, const unsigned *final_states, unsigned final_states_count) {
+    unsigned words = (compiled->number_of_states + 63) / 64;
+    compiled->final_states = (unsigned long long*) allocate_DFA_memory(&compiled->allocator, words * sizeof(unsigned long long), COMPILED_DFA_ALIGNMENT);
+    for (unsigned i = 0; i < final_states_count; i++) {
+        compiled->final_states[final_states[i] / 64] |= 1ULL << (final_states[i] % 64);
+    }
+
+    prepare_state_flags(compiled);
+}
+
+// Letter of a single state's transition together with the class the letter currently belongs to
+typedef struct Class_Edge {
+    unsigned letter_class, destination;
+    unsigned char letter;
+} Class_Edge;
+
+unsigned compute_letter_classes(
+    unsigned number_of_states, unsigned garbage_state,
+    const DFA_Edge *edges, unsigned edge_count,
+    unsigned char *letter_classes
+) {
+    // Start with a single class and refine it by the transitions of every state in turn
+    unsigned class_sizes[DFA_ALPHABET_SIZE] = { DFA_ALPHABET_SIZE };
+    unsigned number_of_classes = 1;
+    memset(letter_classes, 0, DFA_ALPHABET_SIZE);
+
+    // Group the edges by origin state (counting sort)
+    unsigned *group_start = (unsigned*) calloc(number_of_states + 1, sizeof(unsigned));
+    for (unsigned i = 0; i < edge_count; i++) {
+        group_start[edges[i].origin + 1]++;
+    }
+    for (unsigned s = 0; s < number_of_states; s++) {
+        group_start[s + 1] += group_start[s];
+    }
+    unsigned *grouped = (unsigned*) malloc((edge_count + 1) * sizeof(unsigned));
+    unsigned *group_fill = (unsigned*) malloc((number_of_states + 1) * sizeof(unsigned));
+    memcpy(group_fill, group_start, (number_of_states + 1) * sizeof(unsigned));
+    for (unsigned i = 0; i < edge_count; i++) {
+        grouped[group_fill[edges[i].origin]++] = i;
+    }
+
+    Class_Edge state_edges[DFA_ALPHABET_SIZE];
+    for (unsigned s = 0; s < number_of_states; s++) {
+        // Transitions to the garbage state behave exactly like the letters that are not mentioned
+        unsigned count = 0;
+        for (unsigned k = group_start[s]; k < group_start[s + 1]; k++) {
+            DFA_Edge e = edges[grouped[k]];
+            if (e.destination != garbage_state) {
+                state_edges[count].letter_class = letter_classes[e.letter];
+                state_edges[count].destination = e.destination;
+                state_edges[count].letter = e.letter;
+                count++;
+            }
+        }
+        qsort(state_edges, count, sizeof(Class_Edge), compare_class_edges);
+
+        // Within every class, letters that lead to different destinations are split into new classes.
+        // A run of letters keeps the old class only if it covers the whole class.
+        unsigned i = 0;
+        while (i < count) {
+            unsigned old_class = state_edges[i].letter_class;
+            unsigned class_end = i;
+            while (class_end < count && state_edges[class_end].letter_class == old_class) {
+                class_end++;
+            }
+            int keep_old_class = class_end - i == class_sizes[old_class];
+
+            while (i < class_end) {
+                unsigned run_end = i;
+                while (run_end < class_end && state_edges[run_end].destination == state_edges[i].destination) {
+                    run_end++;
+                }
+                if (keep_old_class) {
+                    keep_old_class = 0;
+                } else {
+                    unsigned new_class = number_of_classes++;
+                    class_sizes[new_class] = run_end - i;
+                    class_sizes[old_class] -= run_end - i;
+                    for (unsigned k = i; k < run_end; k++) {
+                        letter_classes[state_edges[k].letter] = new_class;
+                    }
+                }
+                i = run_end;
+            }
+        }
+    }
+
+    free(group_start);
+    free(group_fill);
+    free(grouped);
+    return number_of_classes;
+}
+
+int compare_class_edges(const void *a, const void *b) {
+    const Class_Edge *x = (const Class_Edge*) a, *y = (const Class_Edge*) b;
+    if (x->letter_class != y->letter_class) {
+        return x->letter_class < y->letter_class ? -1 : 1;
+    }
+    if (x->destination != y->destination) {
+        return x->destination < y->destination ? -1 : 1;
+    }
+    return 0;
+}
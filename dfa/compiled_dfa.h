@@ -0,0 +1,157 @@
+#ifndef COMPILED_DFA_H
+#define COMPILED_DFA_H
+
+#include <stddef.h>
+#include "dfa.h"
+#include "dfa_allocator.h"
+
+#define DFA_ALPHABET_SIZE 256
+
+// Transition tables are aligned to the cache line size
+#define COMPILED_DFA_ALIGNMENT 64
+
+// Describes a single transition. It is the common input used to build compiled DFAs.
+typedef struct DFA_Edge {
+    unsigned origin, destination;
+    unsigned char letter;
+} DFA_Edge;
+
+// Flags of states that the run loops treat specially
+#define DFA_STATE_DEAD 1        // no final state can be reached from the state
+#define DFA_STATE_ACCELERATED 2 // the state loops on itself with some letters, so runs of them can be skipped
+
+// Letters that keep a state in itself, in the form used by the skipping kernels
+typedef struct Self_Loop_Set {
+    // One mask per low nibble of the letter (first for letters below 128, then for the rest)
+    // with one bit per high nibble (modulo 8)
+    unsigned char masks[32];
+    unsigned long long bitmap[4];
+} Self_Loop_Set;
+
+// Returns the position of the first letter in letters[position..length) that is not in the set, or length if there is none
+typedef size_t (*Self_Loop_Kernel)(const Self_Loop_Set*, const unsigned char *letters, size_t position, size_t length);
+
+// Immutable run-time representation of a DFA.
+// Letters that behave the same in every state are grouped into classes, and all transitions are packed
+// into one cache-aligned row-major table with one row per state and one column per letter class.
+// State IDs in the table use the narrowest type (1, 2 or 4 bytes) that fits all states.
+// Final states are kept in a separate bitset.
+// Dead states end the run early, and long runs of letters on which a state loops on itself are skipped with SIMD kernels.
+typedef struct Compiled_DFA {
+    unsigned number_of_states; // includes the garbage state
+    unsigned garbage_state;
+
+    unsigned char letter_classes[DFA_ALPHABET_SIZE];
+    unsigned number_of_classes;
+
+    unsigned state_id_width; // size of a state ID in bytes
+    void *transitions;
+    unsigned long long *final_states;
+
+    unsigned char *state_flags;
+    unsigned *self_loop_index; // position of the state's set in self_loops, for accelerated states
+    Self_Loop_Set *self_loops;
+    unsigned number_of_self_loops;
+    Self_Loop_Kernel skip_self_loops;
+
+    // Set if the arrays above point into a read-only file mapping (see map_DFA_binary) rather than the heap
+    void *mapping;
+    size_t mapping_size;
+
+    // Allocator of the structure and of the arrays above (NULL functions stand for aligned_alloc and free)
+    DFA_Allocator allocator;
+} Compiled_DFA;
+
+// Builds a compiled DFA with the given number of states (the garbage state is added on top of it).
+// All transitions that are not listed in the edges lead to the garbage state.
+// Every pair of origin state and letter may appear in the edges at most once.
+struct Compiled_DFA *build_compiled_DFA(
+    unsigned number_of_states,
+    const DFA_Edge *edges, unsigned edge_count,
+    const unsigned *final_states, unsigned final_states_count
+);
+
+// Same as build_compiled_DFA, but the compiled DFA is allocated from the given allocator (see dfa_allocator.h)
+struct Compiled_DFA *build_compiled_DFA_with_allocator(
+    unsigned number_of_states,
+    const DFA_Edge *edges, unsigned edge_count,
+    const unsigned *final_states, unsigned final_states_count,
+    const DFA_Allocator *allocator
+);
+
+// Builds a compiled DFA whose letter classes are already known. class_transitions holds number_of_classes
+// destinations for every state, row after row; the destination number_of_states stands for the garbage state.
+// Letters in different classes may behave the same, which only makes the table wider than needed.
+// The compiled DFA is allocated from the given allocator, which may be NULL.
+struct Compiled_DFA *build_compiled_DFA_from_classes(
+    unsigned number_of_states,
+    const unsigned char *letter_classes, unsigned number_of_classes,
+    const unsigned *class_transitions,
+    const unsigned *final_states, unsigned final_states_count,
+    const DFA_Allocator *allocator
+);
+
+// Builds a compiled DFA from the transitions and final states of the given DFA, using the DFA's allocator
+struct Compiled_DFA *compile_DFA(const struct DFA*);
+
+void delete_compiled_DFA(struct Compiled_DFA*);
+
+// Returns 1 if the input is ACCEPTED, 0 if it is REJECTED
+int run_compiled_DFA(const struct Compiled_DFA*, const char *input, unsigned length);
+
+// Returns the state reached from the given state after reading the whole input.
+// Reading stops as soon as a dead state is reached, in which case that dead state is returned.
+unsigned advance_compiled_DFA(const struct Compiled_DFA*, unsigned state_id, const char *input, size_t length);
+
+// Returns the size of the transition table in bytes
+size_t get_compiled_table_size(const struct Compiled_DFA*);
+
+// Returns the state reached from the given state after reading the letter
+unsigned get_compiled_transition(const struct Compiled_DFA*, unsigned origin, unsigned char letter);
+
+// Returns the state reached from the given state with any letter of the given letter class
+unsigned get_compiled_class_transition(const struct Compiled_DFA*, unsigned origin, unsigned letter_class);
+
+// Returns 1 if the state is final, otherwise 0
+int is_compiled_state_final(const struct Compiled_DFA*, unsigned state_id);
+
+// Returns 1 if no final state can be reached from the state, otherwise 0
+int is_compiled_state_dead(const struct Compiled_DFA*, unsigned state_id);
+
+// Computes the state flags and the self-loop sets of a compiled DFA whose transition table is filled in
+void prepare_state_flags(struct Compiled_DFA*);
+
+// Returns the fastest self-loop skipping kernel supported by the CPU (AVX2, SSSE3 or scalar)
+Self_Loop_Kernel select_self_loop_kernel();
+
+// Adds the letter to the set. The kernels can skip over any set of letters, not only self-loops.
+void add_letter_to_self_loop_set(Self_Loop_Set*, unsigned char letter);
+
+// Builds the minimal DFA equivalent to the compiled DFA (see minimize_DFA), allocated from the same allocator.
+// States start out separated by their labels, where label 0 stands for a non-final state. If no labels are given
+// the finality of the states is used. If new_labels is not NULL it receives a newly allocated array with the label
+// of every state of the minimized DFA.
+struct Compiled_DFA *minimize_compiled_DFA(const struct Compiled_DFA*, const unsigned *labels, unsigned **new_labels);
+
+// Builds a copy of the compiled DFA with its states renumbered (see relayout_DFA), allocated from the same allocator
+struct Compiled_DFA *relayout_compiled_DFA(const struct Compiled_DFA*, const unsigned long long *weights, unsigned *new_ids);
+
+// Native x86-64 code that runs a compiled DFA without looking up its transition table
+struct DFA_Jit;
+
+// Translates the compiled DFA into machine code in an executable mapping. The rest of what it needs is allocated
+// from the compiled DFA's allocator, but the mapping is released only by delete_DFA_jit.
+// Runs of self-loops of accelerated states are still skipped by the compiled DFA, which must outlive the code.
+// Returns NULL if no code can be generated: on other platforms, for automata too large for the generated loop to pay off,
+// or if mapping fails.
+struct DFA_Jit *make_DFA_jit(const struct Compiled_DFA*);
+
+void delete_DFA_jit(struct DFA_Jit*);
+
+// Returns 1 if the input is ACCEPTED, 0 if it is REJECTED
+int run_DFA_jit(const struct DFA_Jit*, const char *input, size_t length);
+
+// Returns the size in bytes of the generated code and its data
+size_t get_DFA_jit_code_size(const struct DFA_Jit*);
+
+#endif
@@ -1,81 +1,389 @@
 #include <stdlib.h>
+#include <string.h>
 #include "dfa.h"
+#include "compiled_dfa.h"
 
 const int ALPHABET_SIZE = 256;
 
+// Sparse states keep at most this many letter ranges; a state that needs more gets a dense row
+#define MAX_SPARSE_RANGES 16
+
+// Letters first..last of a sparse state lead to the destination
+typedef struct Letter_Range {
+    unsigned char first, last;
+    unsigned destination;
+} Letter_Range;
+
+// Most states have only a few transitions that do not lead to the garbage state, so a state keeps them as
+// a sorted list of letter ranges until it has too many of them, and only then gets a row of ALPHABET_SIZE destinations.
 typedef struct State {
     unsigned id;
     int final;
-    unsigned* transitions;
+    unsigned* transitions; // dense row, or NULL if the state is sparse
+    Letter_Range* ranges;  // ranges of a sparse state; letters outside all of them lead to the garbage state
+    unsigned number_of_ranges, ranges_capacity;
 } State;
 
 typedef struct DFA {
-    struct State* states;
+    struct State* states; // NULL if the DFA exists only in its compiled form
     unsigned number_of_states;
+
+    struct Compiled_DFA* compiled; // NULL if the DFA was modified since it was last compiled
+
+    int jit_enabled;
+    struct DFA_Jit* jit; // native code of the compiled form, or NULL if it is disabled or could not be generated
+
+    DFA_Allocator allocator; // allocator of the DFA, its states and its compiled form
 } DFA;
 
 State make_state(unsigned id);
-void delete_state(State state);
+void delete_state(const DFA* dfa, State state);
 
-void set_all_transitions_to_garbage_state(DFA* dfa) {
-    unsigned garbage_state_id = dfa->number_of_states - 1;
-    for(unsigned state_id = 0; state_id < dfa->number_of_states; state_id++) {
-        for(unsigned i = 0; i < ALPHABET_SIZE; i++) {
-            dfa->states[state_id].transitions[i] = garbage_state_id;
-        }
-    }
-}
+unsigned get_state_transition(const State* state, unsigned char letter, unsigned garbage_state_id);
+void set_state_transition(DFA* dfa, State* state, unsigned char letter, unsigned destination);
+
+// Sets all transitions of the state from a row of ALPHABET_SIZE destinations, choosing a sparse or dense layout
+void set_state_row(DFA* dfa, State* state, const unsigned* row);
+
+// Gives the state a dense row that holds the given ranges
+void make_state_dense(DFA* dfa, State* state, const Letter_Range* ranges, unsigned count);
+
+// Appends the range to the ranges, merging it into the last one if it continues it
+void append_letter_range(Letter_Range* ranges, unsigned* count, Letter_Range range);
+
+// Recreates per-state transition arrays from the compiled form so that the DFA can be modified
+void thaw_DFA(DFA* dfa);
+
+// Drops the compiled form after the DFA has been modified
+void invalidate_compiled_DFA(DFA* dfa);
 
 DFA* make_DFA(unsigned number_of_states) {
-    DFA* dfa = (DFA*) malloc(sizeof(DFA));
+    return make_DFA_with_allocator(number_of_states, NULL);
+}
+
+DFA* make_DFA_with_allocator(unsigned number_of_states, const DFA_Allocator* allocator) {
+    DFA* dfa = (DFA*) allocate_DFA_memory(allocator, sizeof(DFA), sizeof(void*));
+    if (allocator != NULL) {
+        dfa->allocator = *allocator;
+    }
     dfa->number_of_states = number_of_states + 1;
-    dfa->states = (struct State*) malloc(dfa->number_of_states * sizeof(struct State));
+    dfa->states = (struct State*) allocate_DFA_memory(allocator, dfa->number_of_states * sizeof(struct State), sizeof(void*));
+    dfa->compiled = NULL;
+    dfa->jit_enabled = 0;
+    dfa->jit = NULL;
 
     for(unsigned i = 0; i < dfa->number_of_states; i++) {
         dfa->states[i] = make_state(i);
     }
+    return dfa;
+}
 
-    set_all_transitions_to_garbage_state(dfa);
+DFA* make_DFA_from_compiled(struct Compiled_DFA* compiled) {
+    DFA* dfa = (DFA*) allocate_DFA_memory(&compiled->allocator, sizeof(DFA), sizeof(void*));
+    dfa->allocator = compiled->allocator;
+    dfa->number_of_states = compiled->number_of_states;
+    dfa->states = NULL;
+    dfa->compiled = compiled;
+    dfa->jit_enabled = 0;
+    dfa->jit = NULL;
     return dfa;
 }
 
 
 void delete_DFA(DFA* dfa) {
     if (dfa != NULL) {
-        for(unsigned i = 0; i < dfa->number_of_states; i++) {
-            delete_state(dfa->states[i]);
+        if (dfa->states != NULL) {
+            for(unsigned i = 0; i < dfa->number_of_states; i++) {
+                delete_state(dfa, dfa->states[i]);
+            }
+            release_DFA_memory(&dfa->allocator, dfa->states);
         }
-        free(dfa);
+        delete_DFA_jit(dfa->jit);
+        delete_compiled_DFA(dfa->compiled);
+        DFA_Allocator allocator = dfa->allocator;
+        release_DFA_memory(&allocator, dfa);
     }
 }
 
+void build_DFA_table(DFA* dfa) {
+    if (dfa->compiled == NULL) {
+        dfa->compiled = compile_DFA(dfa);
+        if (dfa->jit_enabled) {
+            dfa->jit = make_DFA_jit(dfa->compiled);
+        }
+    }
+}
+
+const struct Compiled_DFA* get_compiled_DFA(DFA* dfa) {
+    build_DFA_table(dfa);
+    return dfa->compiled;
+}
+
+unsigned get_DFA_state_id_width(DFA* dfa) {
+    build_DFA_table(dfa);
+    return dfa->compiled->state_id_width;
+}
+
+unsigned get_DFA_number_of_letter_classes(DFA* dfa) {
+    build_DFA_table(dfa);
+    return dfa->compiled->number_of_classes;
+}
+
+size_t get_DFA_table_size(DFA* dfa) {
+    build_DFA_table(dfa);
+    return get_compiled_table_size(dfa->compiled);
+}
+
 int run_DFA(DFA* dfa, const char* input, unsigned length) {
-    unsigned current_state_id = 0;
-    for(unsigned i = 0; i < length; i++) {
-        current_state_id = dfa->states[current_state_id].transitions[input[i]];
+    build_DFA_table(dfa);
+    if (dfa->jit != NULL) {
+        return run_DFA_jit(dfa->jit, input, length);
     }
-    return dfa->states[current_state_id].final == 0 ? 0 : 1;
+    return run_compiled_DFA(dfa->compiled, input, length);
+}
+
+void set_DFA_jit(DFA* dfa, int enabled) {
+    dfa->jit_enabled = enabled != 0;
+    if (!dfa->jit_enabled) {
+        delete_DFA_jit(dfa->jit);
+        dfa->jit = NULL;
+    } else if (dfa->compiled != NULL && dfa->jit == NULL) {
+        dfa->jit = make_DFA_jit(dfa->compiled);
+    }
+}
+
+int is_DFA_jit_active(DFA* dfa) {
+    build_DFA_table(dfa);
+    return dfa->jit != NULL;
 }
 
 
 void add_transition(DFA* dfa, unsigned origin, unsigned destination, char letter) {
-    dfa->states[origin].transitions[letter] = destination;
+    thaw_DFA(dfa);
+    invalidate_compiled_DFA(dfa);
+    set_state_transition(dfa, &dfa->states[origin], (unsigned char) letter, destination);
 }
 
 void mark_state_as_final(DFA* dfa, unsigned state_id) {
+    thaw_DFA(dfa);
+    invalidate_compiled_DFA(dfa);
     dfa->states[state_id].final = 1;
 }
 
+const DFA_Allocator* get_DFA_allocator(const DFA* dfa) {
+    return &dfa->allocator;
+}
+
+unsigned get_number_of_states(const DFA* dfa) {
+    return dfa->number_of_states;
+}
+
+unsigned get_transition(const DFA* dfa, unsigned origin, char letter) {
+    if (dfa->states == NULL) {
+        return get_compiled_transition(dfa->compiled, origin, (unsigned char) letter);
+    }
+    return get_state_transition(&dfa->states[origin], (unsigned char) letter, dfa->number_of_states - 1);
+}
+
+unsigned get_transition_run(const DFA* dfa, unsigned origin, unsigned char letter, unsigned* destination) {
+    const State* state = dfa->states != NULL ? &dfa->states[origin] : NULL;
+    if (state != NULL && state->transitions == NULL) {
+        // The run is the range holding the letter, or the gap between two ranges
+        unsigned garbage_state_id = dfa->number_of_states - 1;
+        for(unsigned i = 0; i < state->number_of_ranges; i++) {
+            const Letter_Range* range = &state->ranges[i];
+            if (letter < range->first) {
+                *destination = garbage_state_id;
+                return range->first - 1;
+            }
+            if (letter <= range->last) {
+                *destination = range->destination;
+                return range->last;
+            }
+        }
+        *destination = garbage_state_id;
+        return ALPHABET_SIZE - 1;
+    }
+
+    *destination = get_transition(dfa, origin, (char) letter);
+    unsigned last = letter;
+    while (last + 1 < (unsigned) ALPHABET_SIZE && get_transition(dfa, origin, (char) (last + 1)) == *destination) {
+        last++;
+    }
+    return last;
+}
+
+int is_final_state(const DFA* dfa, unsigned state_id) {
+    if (dfa->states == NULL) {
+        return is_compiled_state_final(dfa->compiled, state_id);
+    }
+    return dfa->states[state_id].final;
+}
+
 State make_state(unsigned id) {
     State new_state;
 
     new_state.id = id;
     new_state.final = 0;
-    new_state.transitions = malloc(ALPHABET_SIZE * sizeof(unsigned));
-    
+    new_state.transitions = NULL;
+    new_state.ranges = NULL;
+    new_state.number_of_ranges = 0;
+    new_state.ranges_capacity = 0;
+
     return new_state;
 }
 
-void delete_state(State state) {
-    free(state.transitions);
+void delete_state(const DFA* dfa, State state) {
+    release_DFA_memory(&dfa->allocator, state.transitions);
+    release_DFA_memory(&dfa->allocator, state.ranges);
+}
+
+unsigned get_state_transition(const State* state, unsigned char letter, unsigned garbage_state_id) {
+    if (state->transitions != NULL) {
+        return state->transitions[letter];
+    }
+
+    unsigned low = 0, high = state->number_of_ranges;
+    while (low < high) {
+        unsigned middle = (low + high) / 2;
+        if (state->ranges[middle].last < letter) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low < state->number_of_ranges && state->ranges[low].first <= letter) {
+        return state->ranges[low].destination;
+    }
+    return garbage_state_id;
+}
+
+void set_state_transition(DFA* dfa, State* state, unsigned char letter, unsigned destination) {
+    if (state->transitions != NULL) {
+        state->transitions[letter] = destination;
+        return;
+    }
+
+    // The range holding the letter is split around it, and the letter gets a range of its own unless it leads to the garbage state
+    unsigned garbage_state_id = dfa->number_of_states - 1;
+    Letter_Range ranges[MAX_SPARSE_RANGES + 2];
+    Letter_Range single = {letter, letter, destination};
+    unsigned count = 0;
+    int is_inserted = destination == garbage_state_id;
+    for(unsigned i = 0; i < state->number_of_ranges; i++) {
+        Letter_Range range = state->ranges[i];
+        if (!is_inserted && letter < range.first) {
+            append_letter_range(ranges, &count, single);
+            is_inserted = 1;
+        }
+        if (range.first <= letter && letter <= range.last) {
+            if (range.first < letter) {
+                append_letter_range(ranges, &count, (Letter_Range) {range.first, (unsigned char) (letter - 1), range.destination});
+            }
+            if (!is_inserted) {
+                append_letter_range(ranges, &count, single);
+                is_inserted = 1;
+            }
+            if (letter < range.last) {
+                append_letter_range(ranges, &count, (Letter_Range) {(unsigned char) (letter + 1), range.last, range.destination});
+            }
+        } else {
+            append_letter_range(ranges, &count, range);
+        }
+    }
+    if (!is_inserted) {
+        append_letter_range(ranges, &count, single);
+    }
+
+    if (count > MAX_SPARSE_RANGES) {
+        make_state_dense(dfa, state, ranges, count);
+        return;
+    }
+
+    // The capacity grows geometrically, so that an arena does not keep a copy of the ranges for every added transition
+    if (count > state->ranges_capacity) {
+        unsigned capacity = 2 * state->ranges_capacity > count ? 2 * state->ranges_capacity : count;
+        release_DFA_memory(&dfa->allocator, state->ranges);
+        state->ranges = (Letter_Range*) allocate_DFA_memory(&dfa->allocator, capacity * sizeof(Letter_Range), sizeof(unsigned));
+        state->ranges_capacity = capacity;
+    }
+    if (count > 0) {
+        memcpy(state->ranges, ranges, count * sizeof(Letter_Range));
+    }
+    state->number_of_ranges = count;
+}
+
+void set_state_row(DFA* dfa, State* state, const unsigned* row) {
+    unsigned garbage_state_id = dfa->number_of_states - 1;
+    Letter_Range ranges[MAX_SPARSE_RANGES + 1];
+    unsigned count = 0;
+    for(unsigned i = 0; i < (unsigned) ALPHABET_SIZE && count <= MAX_SPARSE_RANGES; i++) {
+        if (row[i] == garbage_state_id) {
+            continue;
+        }
+        if (count > 0 && (unsigned) ranges[count - 1].last + 1 == i && ranges[count - 1].destination == row[i]) {
+            ranges[count - 1].last = (unsigned char) i;
+        } else {
+            ranges[count++] = (Letter_Range) {(unsigned char) i, (unsigned char) i, row[i]};
+        }
+    }
+
+    if (count > MAX_SPARSE_RANGES) {
+        state->transitions = (unsigned*) allocate_DFA_memory(&dfa->allocator, ALPHABET_SIZE * sizeof(unsigned), sizeof(unsigned));
+        memcpy(state->transitions, row, ALPHABET_SIZE * sizeof(unsigned));
+    } else if (count > 0) {
+        state->ranges = (Letter_Range*) allocate_DFA_memory(&dfa->allocator, count * sizeof(Letter_Range), sizeof(unsigned));
+        memcpy(state->ranges, ranges, count * sizeof(Letter_Range));
+        state->number_of_ranges = state->ranges_capacity = count;
+    }
+}
+
+void make_state_dense(DFA* dfa, State* state, const Letter_Range* ranges, unsigned count) {
+    unsigned* row = (unsigned*) allocate_DFA_memory(&dfa->allocator, ALPHABET_SIZE * sizeof(unsigned), sizeof(unsigned));
+    for(unsigned i = 0; i < (unsigned) ALPHABET_SIZE; i++) {
+        row[i] = dfa->number_of_states - 1;
+    }
+    for(unsigned r = 0; r < count; r++) {
+        for(unsigned letter = ranges[r].first; letter <= ranges[r].last; letter++) {
+            row[letter] = ranges[r].destination;
+        }
+    }
+
+    release_DFA_memory(&dfa->allocator, state->ranges);
+    state->ranges = NULL;
+    state->number_of_ranges = state->ranges_capacity = 0;
+    state->transitions = row;
+}
+
+void append_letter_range(Letter_Range* ranges, unsigned* count, Letter_Range range) {
+    Letter_Range* previous = *count > 0 ? &ranges[*count - 1] : NULL;
+    if (previous != NULL && previous->last + 1 == range.first && previous->destination == range.destination) {
+        previous->last = range.last;
+    } else {
+        ranges[(*count)++] = range;
+    }
+}
+
+void thaw_DFA(DFA* dfa) {
+    if (dfa->states != NULL) {
+        return;
+    }
+
+    dfa->states = (struct State*) allocate_DFA_memory(&dfa->allocator, dfa->number_of_states * sizeof(struct State), sizeof(void*));
+    unsigned row[DFA_ALPHABET_SIZE];
+    for(unsigned i = 0; i < dfa->number_of_states; i++) {
+        dfa->states[i] = make_state(i);
+        dfa->states[i].final = is_compiled_state_final(dfa->compiled, i);
+        for(unsigned letter = 0; letter < (unsigned) ALPHABET_SIZE; letter++) {
+            row[letter] = get_compiled_transition(dfa->compiled, i, letter);
+        }
+        set_state_row(dfa, &dfa->states[i], row);
+    }
+}
+
+void invalidate_compiled_DFA(DFA* dfa) {
+    delete_DFA_jit(dfa->jit);
+    dfa->jit = NULL;
+    delete_compiled_DFA(dfa->compiled);
+    dfa->compiled = NULL;
 }
\ No newline at end of file
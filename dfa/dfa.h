@@ -1,11 +1,88 @@
+#include <stddef.h>
+
 struct DFA;
+struct Compiled_DFA;
+struct DFA_Allocator;
 enum Outcome;
 
 struct DFA* make_DFA(unsigned number_of_states);
 void delete_DFA(struct DFA*);
 
+// Same as make_DFA, but the DFA, its states and its compiled form are allocated from the given allocator
+// (see dfa_allocator.h). With an arena, delete_DFA can be skipped and the arena deleted instead,
+// unless native code was generated for the DFA (see set_DFA_jit), whose executable mapping only delete_DFA releases.
+struct DFA* make_DFA_with_allocator(unsigned number_of_states, const struct DFA_Allocator* allocator);
+
+// Returns the allocator the DFA is allocated from
+const struct DFA_Allocator* get_DFA_allocator(const struct DFA*);
+
+// Wraps a compiled DFA (taking its ownership) into a DFA.
+// Such a DFA keeps no per-state transition arrays until it is modified.
+struct DFA* make_DFA_from_compiled(struct Compiled_DFA*);
+
+// Compiles the DFA into its run-time transition table now rather than on the next run.
+// The table uses the narrowest state ID type (1, 2 or 4 bytes) that fits all states, including the garbage state.
+void build_DFA_table(struct DFA*);
+
+// Returns the size in bytes (1, 2 or 4) of the state IDs stored in the DFA's transition table
+unsigned get_DFA_state_id_width(struct DFA*);
+
+// Returns the number of letter classes, i.e. the number of columns in the DFA's transition table
+unsigned get_DFA_number_of_letter_classes(struct DFA*);
+
+// Returns the size of the DFA's transition table in bytes
+size_t get_DFA_table_size(struct DFA*);
+
+// Returns the compiled form of the DFA, compiling it first if needed
+const struct Compiled_DFA* get_compiled_DFA(struct DFA*);
+
+// Returns a new DFA with the minimal number of states that accepts exactly the same words.
+// States unreachable from state 0 are dropped and equivalent states are merged. States from which
+// no final state can be reached are merged into the garbage state of the new DFA.
+struct DFA* minimize_DFA(struct DFA*);
+
+// Returns a new DFA with the same states renumbered so that the states runs move between sit close together
+// in the transition table. State 0 stays the start state and the garbage state stays the last one. The other states
+// are ordered by their weights (e.g. visit counts, higher first), and states of equal weight in breadth first order
+// from state 0, which is also the order used if no weights are given. If new_ids is not NULL it receives
+// the new ID of every state (it must hold get_number_of_states of them).
+struct DFA* relayout_DFA(struct DFA*, const unsigned long long* weights, unsigned* new_ids);
+
 // Returns 1 if the input is ACCEPTED, 0 if it is REJECTED
+// The DFA is compiled into a flat transition table on the first run after it was modified.
 int run_DFA(struct DFA*, const char* input, unsigned length);
 
+// Pass a non-zero integer to make run_DFA use native code generated for the DFA (on x86-64 only), or 0 to use
+// the transition table (the default). The code is generated together with the table. If it cannot be generated,
+// e.g. for automata with very many states, runs keep using the table. The code lives in its own memory mapping,
+// so DFAs allocated from an arena must still be deleted with delete_DFA (or have the code disabled again).
+void set_DFA_jit(struct DFA*, int enabled);
+
+// Returns 1 if run_DFA uses native code generated for the DFA, generating it first if needed, otherwise 0
+int is_DFA_jit_active(struct DFA*);
+
+// Runs the DFA on many independent inputs. Several inputs are advanced in lockstep so that their table lookups overlap.
+// Sets results[i] to 1 if inputs[i] is ACCEPTED, or to 0 if it is REJECTED.
+void run_DFA_batch(struct DFA*, const char* const inputs[], const unsigned lengths[], unsigned count, int results[]);
+
+// Runs the DFA on a single large input split into chunks across the given number of threads
+// (0 uses one thread per online CPU). Every thread maps each possible start state of its chunk to an end state,
+// and the mappings are chained, so the result is the same as the one of run_DFA.
+// Short inputs and automata with many states are run sequentially.
+int run_DFA_parallel(struct DFA*, const char* input, size_t length, unsigned threads);
+
 void add_transition(struct DFA*, unsigned origin, unsigned destination, char letter);
-void mark_state_as_final(struct DFA*, unsigned state_id);
\ No newline at end of file
+void mark_state_as_final(struct DFA*, unsigned state_id);
+
+// Returns the number of states, including the garbage state
+unsigned get_number_of_states(const struct DFA*);
+
+// Returns the destination state of the transition from the origin state with the given letter
+unsigned get_transition(const struct DFA*, unsigned origin, char letter);
+
+// Returns the last letter of the run of consecutive letters, starting with the given one,
+// that lead from the origin state to the same destination, and sets the destination
+unsigned get_transition_run(const struct DFA*, unsigned origin, unsigned char letter, unsigned* destination);
+
+// Returns 1 if the state is final, otherwise 0
+int is_final_state(const struct DFA*, unsigned state_id);
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dfa_allocator.h"
+
+#define DEFAULT_ARENA_BLOCK_SIZE (1u << 20)
+
+// Block of an arena; its memory follows the header
+typedef struct Arena_Block {
+    struct Arena_Block *next;
+    size_t size, used;
+} Arena_Block;
+
+typedef struct DFA_Arena {
+    Arena_Block *blocks; // the block in use first, the first block taken last
+    size_t block_size;
+    size_t total_size;
+} DFA_Arena;
+
+// Helper functions declarations
+
+void *allocate_from_arena(size_t size, size_t alignment, void *context);
+void release_to_arena(void *memory, void *context);
+
+// Adds a block that can hold at least the given number of bytes at any alignment up to the given one
+Arena_Block *add_arena_block(DFA_Arena *arena, size_t size, size_t alignment);
+
+// Definitions of functions from "dfa_allocator.h"
+
+DFA_Arena *make_DFA_arena(size_t block_size) {
+    DFA_Arena *arena = (DFA_Arena*) malloc(sizeof(DFA_Arena));
+    arena->blocks = NULL;
+    arena->block_size = block_size > 0 ? block_size : DEFAULT_ARENA_BLOCK_SIZE;
+    arena->total_size = 0;
+    return arena;
+}
+
+void delete_DFA_arena(DFA_Arena *arena) {
+    if (arena != NULL) {
+        while (arena->blocks != NULL) {
+            Arena_Block *next = arena->blocks->next;
+            free(arena->blocks);
+            arena->blocks = next;
+        }
+        free(arena);
+    }
+}
+
+void reset_DFA_arena(DFA_Arena *arena) {
+    while (arena->blocks != NULL && arena->blocks->next != NULL) {
+        Arena_Block *next = arena->blocks->next;
+        arena->total_size -= sizeof(Arena_Block) + arena->blocks->size;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+    if (arena->blocks != NULL) {
+        arena->blocks->used = 0;
+    }
+}
+
+size_t get_DFA_arena_size(const DFA_Arena *arena) {
+    return arena->total_size;
+}
+
+DFA_Allocator get_DFA_arena_allocator(DFA_Arena *arena) {
+    DFA_Allocator allocator = {allocate_from_arena, release_to_arena, arena};
+    return allocator;
+}
+
+void *allocate_DFA_memory(const DFA_Allocator *allocator, size_t size, size_t alignment) {
+    void *memory;
+    if (allocator == NULL || allocator->allocate == NULL) {
+        // aligned_alloc requires the size to be a multiple of the alignment
+        alignment = alignment < sizeof(void*) ? sizeof(void*) : alignment;
+        size = (size + alignment - 1) / alignment * alignment;
+        memory = aligned_alloc(alignment, size > 0 ? size : alignment);
+    } else {
+        memory = allocator->allocate(size, alignment, allocator->context);
+    }
+    if (memory != NULL) {
+        memset(memory, 0, size);
+    }
+    return memory;
+}
+
+void release_DFA_memory(const DFA_Allocator *allocator, void *memory) {
+    if (memory == NULL) {
+        return;
+    }
+    if (allocator == NULL || allocator->allocate == NULL) {
+        free(memory);
+    } else if (allocator->release != NULL) {
+        allocator->release(memory, allocator->context);
+    }
+}
+
+// Helper functions definitions
+
+void *allocate_from_arena(size_t size, size_t alignment, void *context) {
+    DFA_Arena *arena = (DFA_Arena*) context;
+    Arena_Block *block = arena->blocks;
+    size_t start = 0;
+    if (block != NULL) {
+        // Alignment is applied to the address rather than to the offset in the block
+        size_t address = (size_t) ((char*) (block + 1) + block->used);
+        start = block->used + ((alignment - address % alignment) % alignment);
+    }
+    if (block == NULL || start + size > block->size) {
+        block = add_arena_block(arena, size, alignment);
+        if (block == NULL) {
+            return NULL;
+        }
+        size_t address = (size_t) (block + 1);
+        start = (alignment - address % alignment) % alignment;
+    }
+    block->used = start + size;
+    return (char*) (block + 1) + start;
+}
+
+void release_to_arena(void *memory, void *context) {
+    (void) memory;
+    (void) context;
+}
+
+Arena_Block *add_arena_block(DFA_Arena *arena, size_t size, size_t alignment) {
+    size_t block_size = size + alignment > arena->block_size ? size + alignment : arena->block_size;
+    Arena_Block *block = (Arena_Block*) malloc(sizeof(Arena_Block) + block_size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->size = block_size;
+    block->used = 0;
+    arena->total_size += sizeof(Arena_Block) + block_size;
+
+    // A block that is larger than usual goes behind the block in use, so the rest of that one is not wasted
+    if (block_size > arena->block_size && arena->blocks != NULL) {
+        block->next = arena->blocks->next;
+        arena->blocks->next = block;
+    } else {
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+    return block;
+}
@@ -0,0 +1,44 @@
+#ifndef DFA_ALLOCATOR_H
+#define DFA_ALLOCATOR_H
+
+#include <stddef.h>
+
+// Source of the memory that a DFA is made of. allocate returns memory of the given size aligned to the given
+// alignment (a power of two), or NULL. release gives back memory returned by allocate; it may do nothing,
+// e.g. for an arena that gives all its memory back at once. Functions that take an allocator use
+// aligned_alloc and free when it is NULL.
+typedef struct DFA_Allocator {
+    void *(*allocate)(size_t size, size_t alignment, void *context);
+    void (*release)(void *memory, void *context);
+    void *context;
+} DFA_Allocator;
+
+// Region that hands out memory from large blocks by moving a pointer, and gives it all back at once.
+// Many DFAs that are loaded and unloaded together can share an arena, so that each of them takes no allocations
+// of its own and unloading them is a single call. An arena is not thread-safe.
+struct DFA_Arena;
+
+// Instantiates an arena that takes blocks of the given size (0 stands for 1 MiB) from the system.
+// Larger allocations get blocks of their own.
+struct DFA_Arena *make_DFA_arena(size_t block_size);
+
+// Gives back all memory of the arena, including that of the DFAs allocated from it
+void delete_DFA_arena(struct DFA_Arena*);
+
+// Makes all memory of the arena available again, keeping only its first block.
+// DFAs allocated from it must not be used afterwards.
+void reset_DFA_arena(struct DFA_Arena*);
+
+// Returns the number of bytes the arena took from the system
+size_t get_DFA_arena_size(const struct DFA_Arena*);
+
+// Returns the allocator that allocates from the arena. Its release does nothing.
+DFA_Allocator get_DFA_arena_allocator(struct DFA_Arena*);
+
+// Allocates zeroed memory from the allocator (or with aligned_alloc if it is NULL)
+void *allocate_DFA_memory(const DFA_Allocator*, size_t size, size_t alignment);
+
+// Gives memory back to the allocator (or frees it if the allocator is NULL). Does nothing for NULL memory.
+void release_DFA_memory(const DFA_Allocator*, void *memory);
+
+#endif
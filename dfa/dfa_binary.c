@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dfa_binary.h"
+#include "compiled_dfa.h"
+
+#define DFA_BINARY_MAGIC "DFA-BIN\n"
+#define DFA_BINARY_VERSION 1
+#define DFA_BINARY_BYTE_ORDER 0x01020304u
+#define DFA_BINARY_CHECKSUM_BASIS 0xcbf29ce484222325ULL
+
+// Every section of the file starts at a multiple of this, so the mapped tables stay cache-aligned
+#define DFA_BINARY_SECTION_ALIGNMENT COMPILED_DFA_ALIGNMENT
+
+// File header. It is followed by the sections, in order: letter classes, transition table, final states bitset,
+// state flags, self-loop indexes and self-loop sets. Section sizes follow from the counts in the header.
+typedef struct DFA_Binary_Header {
+    char magic[8];
+    unsigned version;
+    unsigned byte_order;
+
+    unsigned number_of_states;
+    unsigned garbage_state;
+    unsigned number_of_classes;
+    unsigned state_id_width;
+    unsigned number_of_self_loops;
+    unsigned reserved;
+
+    unsigned long long payload_size; // size of everything after the header
+    unsigned long long checksum;     // checksum of everything after the header
+
+    char padding[DFA_BINARY_SECTION_ALIGNMENT - 56];
+} DFA_Binary_Header;
+
+typedef struct DFA_Binary_Sections {
+    size_t letter_classes, transitions, final_states, state_flags, self_loop_index, self_loops, end;
+} DFA_Binary_Sections;
+
+// Helper functions declarations
+
+// Computes the offsets of the sections relative to the end of the header
+DFA_Binary_Sections get_binary_sections(const DFA_Binary_Header *header);
+
+size_t align_section(size_t offset);
+
+// FNV-1a over 64-bit words, continued from the given checksum; sizes are always multiples of 8
+unsigned long long update_binary_checksum(unsigned long long checksum, const unsigned char *bytes, size_t size);
+
+// Checksums the payload one section at a time and, while a section is in cache, checks that the indexes in it
+// are in range, so that a corrupted file cannot make runs read out of bounds.
+// Returns NULL if the payload is valid, otherwise the reason why it is not.
+const char *validate_binary_payload(const DFA_Binary_Header *header, const DFA_Binary_Sections *sections, const unsigned char *payload);
+
+// Returns the largest state ID in the transition table
+unsigned get_largest_binary_state_id(const unsigned char *transitions, size_t cells, unsigned state_id_width);
+
+// Copies the section into the payload. The payload is zeroed, so the padding after the section stays zero.
+void write_binary_section(unsigned char *payload, size_t offset, const void *data, size_t size);
+
+struct DFA *binary_mapping_error(const char *filename, const char *reason, int enabled_error_printing, void *mapping, size_t mapping_size);
+
+// Definitions of functions from "dfa_binary.h"
+
+int save_DFA_binary(struct DFA *dfa, const char *filename) {
+    const Compiled_DFA *compiled = get_compiled_DFA(dfa);
+
+    DFA_Binary_Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DFA_BINARY_MAGIC, sizeof(header.magic));
+    header.version = DFA_BINARY_VERSION;
+    header.byte_order = DFA_BINARY_BYTE_ORDER;
+    header.number_of_states = compiled->number_of_states;
+    header.garbage_state = compiled->garbage_state;
+    header.number_of_classes = compiled->number_of_classes;
+    header.state_id_width = compiled->state_id_width;
+    header.number_of_self_loops = compiled->number_of_self_loops;
+
+    DFA_Binary_Sections sections = get_binary_sections(&header);
+    unsigned char *payload = (unsigned char*) calloc(sections.end, 1);
+    write_binary_section(payload, sections.letter_classes, compiled->letter_classes, DFA_ALPHABET_SIZE);
+    write_binary_section(payload, sections.transitions, compiled->transitions, get_compiled_table_size(compiled));
+    write_binary_section(payload, sections.final_states, compiled->final_states, (compiled->number_of_states + 63) / 64 * sizeof(unsigned long long));
+    write_binary_section(payload, sections.state_flags, compiled->state_flags, compiled->number_of_states);
+    write_binary_section(payload, sections.self_loop_index, compiled->self_loop_index, (size_t) compiled->number_of_states * sizeof(unsigned));
+    write_binary_section(payload, sections.self_loops, compiled->self_loops, (size_t) compiled->number_of_self_loops * sizeof(Self_Loop_Set));
+
+    header.payload_size = sections.end;
+    header.checksum = update_binary_checksum(DFA_BINARY_CHECKSUM_BASIS, payload, sections.end);
+
+    FILE *file = fopen(filename, "wb");
+    int written = file != NULL
+        && fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(payload, 1, sections.end, file) == sections.end;
+    if (file != NULL) {
+        written = fclose(file) == 0 && written;
+    }
+
+    free(payload);
+    return written ? 1 : 0;
+}
+
+struct DFA *map_DFA_binary(const char *filename, int enabled_error_printing) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return binary_mapping_error(filename, "make sure the file exists", enabled_error_printing, NULL, 0);
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (size_t) file_stat.st_size < sizeof(DFA_Binary_Header)) {
+        close(fd);
+        return binary_mapping_error(filename, "the file is too short to be a DFA binary", enabled_error_printing, NULL, 0);
+    }
+
+    size_t mapping_size = (size_t) file_stat.st_size;
+    void *mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return binary_mapping_error(filename, "the file could not be mapped", enabled_error_printing, NULL, 0);
+    }
+
+    const DFA_Binary_Header *header = (const DFA_Binary_Header*) mapping;
+    if (memcmp(header->magic, DFA_BINARY_MAGIC, sizeof(header->magic)) != 0) {
+        return binary_mapping_error(filename, "the file is not a DFA binary", enabled_error_printing, mapping, mapping_size);
+    }
+    if (header->version != DFA_BINARY_VERSION) {
+        return binary_mapping_error(filename, "unsupported DFA binary version", enabled_error_printing, mapping, mapping_size);
+    }
+    if (header->byte_order != DFA_BINARY_BYTE_ORDER) {
+        return binary_mapping_error(filename, "the file was written with a different byte order", enabled_error_printing, mapping, mapping_size);
+    }
+
+    DFA_Binary_Sections sections = get_binary_sections(header);
+    int is_consistent = header->number_of_states > 0
+        && header->garbage_state < header->number_of_states
+        && header->number_of_classes > 0 && header->number_of_classes <= DFA_ALPHABET_SIZE
+        && (header->state_id_width == 1 || header->state_id_width == 2 || header->state_id_width == 4)
+        && header->payload_size == sections.end
+        && mapping_size == sizeof(DFA_Binary_Header) + sections.end;
+    if (!is_consistent) {
+        return binary_mapping_error(filename, "the file is truncated or its header is corrupted", enabled_error_printing, mapping, mapping_size);
+    }
+
+    const unsigned char *payload = (const unsigned char*) mapping + sizeof(DFA_Binary_Header);
+    const char *reason = validate_binary_payload(header, &sections, payload);
+    if (reason != NULL) {
+        return binary_mapping_error(filename, reason, enabled_error_printing, mapping, mapping_size);
+    }
+
+    // The arrays are used in place; only the letter classes are copied into the structure
+    Compiled_DFA *compiled = (Compiled_DFA*) allocate_DFA_memory(NULL, sizeof(Compiled_DFA), COMPILED_DFA_ALIGNMENT);
+    compiled->number_of_states = header->number_of_states;
+    compiled->garbage_state = header->garbage_state;
+    compiled->number_of_classes = header->number_of_classes;
+    compiled->state_id_width = header->state_id_width;
+    compiled->number_of_self_loops = header->number_of_self_loops;
+    memcpy(compiled->letter_classes, payload + sections.letter_classes, DFA_ALPHABET_SIZE);
+    compiled->transitions = (void*) (payload + sections.transitions);
+    compiled->final_states = (unsigned long long*) (payload + sections.final_states);
+    compiled->state_flags = (unsigned char*) (payload + sections.state_flags);
+    compiled->self_loop_index = (unsigned*) (payload + sections.self_loop_index);
+    compiled->self_loops = (Self_Loop_Set*) (payload + sections.self_loops);
+    compiled->skip_self_loops = select_self_loop_kernel();
+    compiled->mapping = mapping;
+    compiled->mapping_size = mapping_size;
+
+    return make_DFA_from_compiled(compiled);
+}
+
+// Helper functions definitions
+
+DFA_Binary_Sections get_binary_sections(const DFA_Binary_Header *header) {
+    DFA_Binary_Sections sections;
+    size_t n = header->number_of_states;
+
+    sections.letter_classes = 0;
+    sections.transitions = align_section(sections.letter_classes + DFA_ALPHABET_SIZE);
+    sections.final_states = align_section(sections.transitions + n * header->number_of_classes * header->state_id_width);
+    sections.state_flags = align_section(sections.final_states + (n + 63) / 64 * sizeof(unsigned long long));
+    sections.self_loop_index = align_section(sections.state_flags + n);
+    sections.self_loops = align_section(sections.self_loop_index + n * sizeof(unsigned));
+    sections.end = align_section(sections.self_loops + (size_t) header->number_of_self_loops * sizeof(Self_Loop_Set));
+    return sections;
+}
+
+size_t align_section(size_t offset) {
+    return (offset + DFA_BINARY_SECTION_ALIGNMENT - 1) / DFA_BINARY_SECTION_ALIGNMENT * DFA_BINARY_SECTION_ALIGNMENT;
+}
+
+unsigned long long update_binary_checksum(unsigned long long checksum, const unsigned char *bytes, size_t size) {
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, bytes + i, sizeof(word));
+        checksum = (checksum ^ word) * 0x100000001b3ULL;
+    }
+    return checksum;
+}
+
+const char *validate_binary_payload(const DFA_Binary_Header *header, const DFA_Binary_Sections *sections, const unsigned char *payload) {
+    // The first problem found is reported, unless the checksum shows that the file is corrupted
+    const char *reason = NULL;
+    unsigned n = header->number_of_states;
+
+    unsigned long long checksum = update_binary_checksum(DFA_BINARY_CHECKSUM_BASIS, payload, sections->transitions);
+    unsigned largest_class = 0;
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        unsigned letter_class = payload[sections->letter_classes + letter];
+        largest_class = letter_class > largest_class ? letter_class : largest_class;
+    }
+    if (largest_class >= header->number_of_classes) {
+        reason = "a letter belongs to a class that does not exist";
+    }
+
+    checksum = update_binary_checksum(checksum, payload + sections->transitions, sections->final_states - sections->transitions);
+    size_t cells = (size_t) n * header->number_of_classes;
+    if (reason == NULL && get_largest_binary_state_id(payload + sections->transitions, cells, header->state_id_width) >= n) {
+        reason = "a transition leads to a state that does not exist";
+    }
+
+    checksum = update_binary_checksum(checksum, payload + sections->final_states, sections->self_loop_index - sections->final_states);
+    const unsigned long long *final_states = (const unsigned long long*) (payload + sections->final_states);
+    const unsigned char *state_flags = payload + sections->state_flags;
+    unsigned garbage = header->garbage_state;
+    int is_garbage_final = (final_states[garbage / 64] >> (garbage % 64)) & 1;
+    if (reason == NULL && (!(state_flags[garbage] & DFA_STATE_DEAD) || is_garbage_final)) {
+        reason = "the garbage state is not a dead, rejecting state";
+    }
+
+    checksum = update_binary_checksum(checksum, payload + sections->self_loop_index, sections->self_loops - sections->self_loop_index);
+    const unsigned *self_loop_index = (const unsigned*) (payload + sections->self_loop_index);
+    for (unsigned state = 0; state < n && reason == NULL; state++) {
+        if ((state_flags[state] & DFA_STATE_ACCELERATED) && self_loop_index[state] >= header->number_of_self_loops) {
+            reason = "an accelerated state refers to a self-loop set that does not exist";
+        }
+    }
+
+    checksum = update_binary_checksum(checksum, payload + sections->self_loops, sections->end - sections->self_loops);
+    return checksum != header->checksum ? "checksum mismatch" : reason;
+}
+
+unsigned get_largest_binary_state_id(const unsigned char *transitions, size_t cells, unsigned state_id_width) {
+    // One loop per width, without branches in the loop bodies
+    unsigned largest = 0;
+    if (state_id_width == 1) {
+        for (size_t cell = 0; cell < cells; cell++) {
+            largest = transitions[cell] > largest ? transitions[cell] : largest;
+        }
+    } else if (state_id_width == 2) {
+        const unsigned short *ids = (const unsigned short*) transitions;
+        for (size_t cell = 0; cell < cells; cell++) {
+            largest = ids[cell] > largest ? ids[cell] : largest;
+        }
+    } else {
+        const unsigned *ids = (const unsigned*) transitions;
+        for (size_t cell = 0; cell < cells; cell++) {
+            largest = ids[cell] > largest ? ids[cell] : largest;
+        }
+    }
+    return largest;
+}
+
+void write_binary_section(unsigned char *payload, size_t offset, const void *data, size_t size) {
+    memcpy(payload + offset, data, size);
+}
+
+struct DFA *binary_mapping_error(const char *filename, const char *reason, int enabled_error_printing, void *mapping, size_t mapping_size) {
+    if (mapping != NULL) {
+        munmap(mapping, mapping_size);
+    }
+    if (enabled_error_printing) {
+        printf("error while mapping the DFA binary \"%s\": %s.\n", filename, reason);
+    }
+    return NULL;
+}
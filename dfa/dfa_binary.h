@@ -0,0 +1,12 @@
+#include "dfa.h"
+
+// Saves the compiled form of the DFA (compiling it first if needed) to a binary file that map_DFA_binary can load.
+// Returns 1 if the file was written, otherwise 0.
+int save_DFA_binary(struct DFA*, const char *filename);
+
+// Maps a file written by save_DFA_binary read-only into memory and runs the DFA straight from the mapping:
+// nothing is parsed and no per-state memory is allocated, and processes mapping the same file share its pages.
+// Returns NULL if the file cannot be mapped, was written by an unsupported version or on a machine with a different
+// byte order, fails the checksum, or holds letter classes, state IDs or self-loop indexes out of range.
+// Pass a non-zero integer for the second parameter to enable printing of errors.
+struct DFA *map_DFA_binary(const char *filename, int enabled_error_printing);
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dfa_profile.h"
+#include "compiled_dfa.h"
+
+typedef struct DFA_Profile {
+    struct DFA *dfa;
+    unsigned number_of_states;
+    unsigned number_of_classes;
+
+    unsigned long long *visits;      // per state
+    unsigned long long *transitions; // per state and letter class, in the layout of the transition table
+
+    unsigned long long runs, accepted_runs;
+    unsigned long long bytes_given, bytes_processed;
+
+    // Positions of the letters with which runs entered a dead state
+    unsigned long long dead_entries, dead_position_sum;
+    size_t dead_position_min, dead_position_max;
+} DFA_Profile;
+
+// Context of write_dot_edge
+typedef struct Dot_Edge_Context {
+    unsigned origin;
+    unsigned long long max_count;
+} Dot_Edge_Context;
+
+// Helper functions declarations
+
+// Writes the letters of the set as comma separated letters and ranges of letters, e.g. "0-9,_,a-z".
+// Letters that are not printable or are used by the notation are written as \xHH.
+void format_letters(const unsigned char *in_set, char *buffer);
+
+// Writes the string in double quotes with the quotes and backslashes in it escaped (valid in JSON and DOT)
+void write_quoted(FILE *file, const char *string);
+
+// Calls the callback for every group of letter classes that lead from the state to the same destination,
+// leaving out groups that lead to the garbage state and were never taken
+void for_each_profiled_edge(
+    const DFA_Profile *profile, const Compiled_DFA *compiled, unsigned state,
+    void (*callback)(FILE*, unsigned destination, const char *letters, unsigned long long count, void*), FILE *file, void *context
+);
+
+void write_json_edge(FILE *file, unsigned destination, const char *letters, unsigned long long count, void *context);
+void write_dot_edge(FILE *file, unsigned destination, const char *letters, unsigned long long count, void *context);
+
+// Definitions of functions from "dfa_profile.h"
+
+DFA_Profile *make_DFA_profile(struct DFA *dfa) {
+    const Compiled_DFA *compiled = get_compiled_DFA(dfa);
+    DFA_Profile *profile = (DFA_Profile*) malloc(sizeof(DFA_Profile));
+    profile->dfa = dfa;
+    profile->number_of_states = compiled->number_of_states;
+    profile->number_of_classes = compiled->number_of_classes;
+    profile->visits = (unsigned long long*) malloc(profile->number_of_states * sizeof(unsigned long long));
+    profile->transitions = (unsigned long long*) malloc(
+        (size_t) profile->number_of_states * profile->number_of_classes * sizeof(unsigned long long)
+    );
+    reset_DFA_profile(profile);
+    return profile;
+}
+
+void delete_DFA_profile(DFA_Profile *profile) {
+    if (profile != NULL) {
+        free(profile->visits);
+        free(profile->transitions);
+        free(profile);
+    }
+}
+
+void reset_DFA_profile(DFA_Profile *profile) {
+    memset(profile->visits, 0, profile->number_of_states * sizeof(unsigned long long));
+    memset(profile->transitions, 0, (size_t) profile->number_of_states * profile->number_of_classes * sizeof(unsigned long long));
+    profile->runs = profile->accepted_runs = 0;
+    profile->bytes_given = profile->bytes_processed = 0;
+    profile->dead_entries = profile->dead_position_sum = 0;
+    profile->dead_position_min = profile->dead_position_max = 0;
+}
+
+int run_DFA_profiled(DFA_Profile *profile, const char *input, size_t length) {
+    const Compiled_DFA *compiled = get_compiled_DFA(profile->dfa);
+    const unsigned char *letters = (const unsigned char*) input;
+
+    // Stops at a dead state like advance_compiled_DFA, but reads every letter itself so that all of them are counted
+    unsigned state = 0;
+    size_t i = 0;
+    profile->visits[0]++;
+    while (i < length) {
+        unsigned letter_class = compiled->letter_classes[letters[i]];
+        profile->transitions[(size_t) state * profile->number_of_classes + letter_class]++;
+        state = get_compiled_class_transition(compiled, state, letter_class);
+        profile->visits[state]++;
+        i++;
+        if (is_compiled_state_dead(compiled, state)) {
+            size_t position = i - 1;
+            profile->dead_position_min = profile->dead_entries == 0 || position < profile->dead_position_min ? position : profile->dead_position_min;
+            profile->dead_position_max = position > profile->dead_position_max ? position : profile->dead_position_max;
+            profile->dead_position_sum += position;
+            profile->dead_entries++;
+            break;
+        }
+    }
+
+    int is_accepted = is_compiled_state_final(compiled, state);
+    profile->runs++;
+    profile->accepted_runs += is_accepted;
+    profile->bytes_given += length;
+    profile->bytes_processed += i;
+    return is_accepted;
+}
+
+unsigned long long get_profiled_state_visits(const DFA_Profile *profile, unsigned state_id) {
+    return profile->visits[state_id];
+}
+
+unsigned long long get_profiled_transition_count(const DFA_Profile *profile, unsigned origin, char letter) {
+    const Compiled_DFA *compiled = get_compiled_DFA(profile->dfa);
+    return profile->transitions[(size_t) origin * profile->number_of_classes + compiled->letter_classes[(unsigned char) letter]];
+}
+
+unsigned long long get_profiled_bytes_processed(const DFA_Profile *profile) {
+    return profile->bytes_processed;
+}
+
+struct DFA *relayout_DFA_by_profile(const DFA_Profile *profile, unsigned *new_ids) {
+    return relayout_DFA(profile->dfa, profile->visits, new_ids);
+}
+
+int save_DFA_profile_json(const DFA_Profile *profile, const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    const Compiled_DFA *compiled = get_compiled_DFA(profile->dfa);
+
+    fprintf(
+        file,
+        "{\n"
+        "  \"number_of_states\": %u,\n"
+        "  \"garbage_state\": %u,\n"
+        "  \"runs\": %llu,\n"
+        "  \"accepted_runs\": %llu,\n"
+        "  \"bytes_given\": %llu,\n"
+        "  \"bytes_processed\": %llu,\n"
+        "  \"dead_entries\": {\"count\": %llu, \"min_position\": %zu, \"max_position\": %zu, \"mean_position\": %.1f},\n"
+        "  \"states\": [",
+        profile->number_of_states, compiled->garbage_state, profile->runs, profile->accepted_runs,
+        profile->bytes_given, profile->bytes_processed, profile->dead_entries, profile->dead_position_min,
+        profile->dead_position_max, profile->dead_entries > 0 ? (double) profile->dead_position_sum / profile->dead_entries : 0.0
+    );
+    for (unsigned state = 0; state < profile->number_of_states; state++) {
+        fprintf(
+            file,
+            "%s\n    {\"id\": %u, \"final\": %s, \"dead\": %s, \"visits\": %llu, \"transitions\": [",
+            state == 0 ? "" : ",", state, is_compiled_state_final(compiled, state) ? "true" : "false",
+            is_compiled_state_dead(compiled, state) ? "true" : "false", profile->visits[state]
+        );
+        int is_first = 1;
+        for_each_profiled_edge(profile, compiled, state, write_json_edge, file, &is_first);
+        fprintf(file, "]}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int save_DFA_profile_dot(const DFA_Profile *profile, const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        return 0;
+    }
+    const Compiled_DFA *compiled = get_compiled_DFA(profile->dfa);
+
+    Dot_Edge_Context context = {0, 0};
+    unsigned long long max_visits = 0;
+    for (unsigned state = 0; state < profile->number_of_states; state++) {
+        max_visits = profile->visits[state] > max_visits ? profile->visits[state] : max_visits;
+    }
+    size_t cells = (size_t) profile->number_of_states * profile->number_of_classes;
+    for (size_t i = 0; i < cells; i++) {
+        context.max_count = profile->transitions[i] > context.max_count ? profile->transitions[i] : context.max_count;
+    }
+
+    fprintf(file, "digraph DFA {\n  rankdir=LR;\n  node [style=filled, fontcolor=white];\n");
+    for (unsigned state = 0; state < profile->number_of_states; state++) {
+        if (state == compiled->garbage_state && profile->visits[state] == 0) {
+            continue;
+        }
+        // The hue goes from blue (never visited) to red (visited the most)
+        double heat = max_visits > 0 ? (double) profile->visits[state] / max_visits : 0.0;
+        fprintf(
+            file,
+            "  %u [shape=%s, fillcolor=\"%.3f 0.850 0.850\", label=\"%u\\n%llu visits\"];\n",
+            state, is_compiled_state_final(compiled, state) ? "doublecircle" : "circle",
+            0.667 * (1.0 - heat), state, profile->visits[state]
+        );
+    }
+    for (unsigned state = 0; state < profile->number_of_states; state++) {
+        context.origin = state;
+        for_each_profiled_edge(profile, compiled, state, write_dot_edge, file, &context);
+    }
+    fprintf(file, "}\n");
+    return fclose(file) == 0;
+}
+
+// Helper functions definitions
+
+void format_letters(const unsigned char *in_set, char *buffer) {
+    size_t length = 0;
+    unsigned letter = 0;
+    while (letter < DFA_ALPHABET_SIZE) {
+        if (!in_set[letter]) {
+            letter++;
+            continue;
+        }
+        unsigned last = letter;
+        while (last + 1 < DFA_ALPHABET_SIZE && in_set[last + 1]) {
+            last++;
+        }
+
+        // A range is written as its first and last letter, but two letters are simply listed
+        unsigned ends[2] = {letter, last};
+        for (unsigned e = 0; e < (letter == last ? 1u : 2u); e++) {
+            if (e == 0 && length > 0) {
+                buffer[length++] = ',';
+            }
+            if (e == 1) {
+                buffer[length++] = last == letter + 1 ? ',' : '-';
+            }
+            unsigned c = ends[e];
+            if ('!' <= c && c <= '~' && c != ',' && c != '-' && c != '\\') {
+                buffer[length++] = (char) c;
+            } else {
+                length += sprintf(buffer + length, "\\x%02X", c);
+            }
+        }
+        letter = last + 1;
+    }
+    buffer[length] = '\0';
+}
+
+void write_quoted(FILE *file, const char *string) {
+    fputc('"', file);
+    for (; *string != '\0'; string++) {
+        if (*string == '"' || *string == '\\') {
+            fputc('\\', file);
+        }
+        fputc(*string, file);
+    }
+    fputc('"', file);
+}
+
+void for_each_profiled_edge(
+    const DFA_Profile *profile, const Compiled_DFA *compiled, unsigned state,
+    void (*callback)(FILE*, unsigned destination, const char *letters, unsigned long long count, void*), FILE *file, void *context
+) {
+    unsigned char is_done[DFA_ALPHABET_SIZE] = {0};
+    const unsigned long long *counts = profile->transitions + (size_t) state * profile->number_of_classes;
+    for (unsigned c = 0; c < profile->number_of_classes; c++) {
+        if (is_done[c]) {
+            continue;
+        }
+        unsigned destination = get_compiled_class_transition(compiled, state, c);
+        unsigned long long count = 0;
+        for (unsigned other = c; other < profile->number_of_classes; other++) {
+            if (!is_done[other] && get_compiled_class_transition(compiled, state, other) == destination) {
+                is_done[other] = 1;
+                count += counts[other];
+            }
+        }
+        if (destination == compiled->garbage_state && count == 0) {
+            continue;
+        }
+
+        unsigned char in_set[DFA_ALPHABET_SIZE];
+        for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+            in_set[letter] = get_compiled_class_transition(compiled, state, compiled->letter_classes[letter]) == destination;
+        }
+        char letters[4 * DFA_ALPHABET_SIZE + DFA_ALPHABET_SIZE + 1];
+        format_letters(in_set, letters);
+        callback(file, destination, letters, count, context);
+    }
+}
+
+void write_json_edge(FILE *file, unsigned destination, const char *letters, unsigned long long count, void *context) {
+    int *is_first = (int*) context;
+    fprintf(file, "%s{\"destination\": %u, \"letters\": ", *is_first ? "" : ", ", destination);
+    write_quoted(file, letters);
+    fprintf(file, ", \"count\": %llu}", count);
+    *is_first = 0;
+}
+
+void write_dot_edge(FILE *file, unsigned destination, const char *letters, unsigned long long count, void *context) {
+    const Dot_Edge_Context *edge_context = (const Dot_Edge_Context*) context;
+    double heat = edge_context->max_count > 0 ? (double) count / edge_context->max_count : 0.0;
+    fprintf(file, "  %u -> %u [label=", edge_context->origin, destination);
+    char label[4 * DFA_ALPHABET_SIZE + DFA_ALPHABET_SIZE + 32];
+    snprintf(label, sizeof(label), "%s (%llu)", letters, count);
+    write_quoted(file, label);
+    fprintf(file, ", penwidth=%.2f];\n", 1.0 + 4.0 * heat);
+}
@@ -0,0 +1,44 @@
+#include <stddef.h>
+#include "dfa.h"
+
+// Records what runs of a DFA did: how often every state was visited and every transition taken,
+// how many letters were read, and where runs entered a dead state and stopped early.
+// Profiled runs go through a separate, slower loop, so run_DFA itself is not affected.
+// The DFA must not be modified while it is profiled.
+struct DFA_Profile;
+
+// Instantiates an empty profile of the DFA
+struct DFA_Profile *make_DFA_profile(struct DFA*);
+
+void delete_DFA_profile(struct DFA_Profile*);
+
+// Sets all counts back to 0
+void reset_DFA_profile(struct DFA_Profile*);
+
+// Runs the DFA like run_DFA and adds what the run did to the profile.
+// Returns 1 if the input is ACCEPTED, 0 if it is REJECTED
+int run_DFA_profiled(struct DFA_Profile*, const char *input, size_t length);
+
+// Returns the number of times profiled runs were in the state, counting the start of every run in state 0
+unsigned long long get_profiled_state_visits(const struct DFA_Profile*, unsigned state_id);
+
+// Returns the number of times profiled runs took the transition from the origin state with the given letter
+// or with any other letter that behaves the same in every state
+unsigned long long get_profiled_transition_count(const struct DFA_Profile*, unsigned origin, char letter);
+
+// Returns the number of letters read by profiled runs. Runs stop reading once they enter a dead state,
+// so this may be less than the total length of the inputs.
+unsigned long long get_profiled_bytes_processed(const struct DFA_Profile*);
+
+// Returns a new DFA with the states of the profiled DFA renumbered so that the most visited ones come first
+// (see relayout_DFA). The profile still refers to the old DFA.
+struct DFA *relayout_DFA_by_profile(const struct DFA_Profile*, unsigned *new_ids);
+
+// Saves the profile together with the states and transitions of the DFA as a JSON document.
+// Returns 1 if the file was written, otherwise 0.
+int save_DFA_profile_json(const struct DFA_Profile*, const char *filename);
+
+// Saves the DFA as a Graphviz DOT graph whose states are colored by how often they were visited (from blue to red)
+// and whose transitions are labeled with their letters and counts. The garbage state is left out unless it was visited.
+// Returns 1 if the file was written, otherwise 0.
+int save_DFA_profile_dot(const struct DFA_Profile*, const char *filename);
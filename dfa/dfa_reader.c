@@ -1,76 +1,109 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <regex.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "errors.h"
 #include "dfa_reader.h"
+#include "compiled_dfa.h"
 
 
 typedef enum DFA_Reader_State { STATE_NUMBER, FINAL_STATES, TRANSITIONS } DFA_Reader_State;
 
-typedef struct Transition {
-    unsigned origin, destination;
-    char letter;
-
-    unsigned line_number; // meta information for error messages
-} Transition;
-
 typedef struct DFA_Reader {
     char *error_message;
     enum DFA_Reader_State state;
 
     unsigned line_number;
 
-    regex_t empty_re;
-
-    regex_t number_of_states_re;
-    
-    regex_t final_states_none_re;
-    regex_t final_states_re;
-    
-    regex_t transition_re;
-
     unsigned number_of_states;
 
     unsigned *final_states;
     unsigned final_states_count;
+    unsigned final_states_capacity;
 
-    Transition *transitions;
+    // Transitions are stored as the edges the compiled table is built from, so they are not copied again.
+    // The line numbers are meta information for error messages.
+    DFA_Edge *transitions;
+    unsigned *transition_line_numbers;
     unsigned transition_count;
+    unsigned transition_capacity;
+
+    // Open addressing hash table of (origin, letter) -> transition index + 1; 0 marks an empty slot
+    unsigned *transition_index;
+    unsigned transition_index_capacity;
+
+    int minimization_enabled;
+
+    // Allocator of the DFA made by finish_and_get_DFA
+    DFA_Allocator allocator;
 } DFA_Reader;
 
+// A number within a line: line[start..end)
+typedef struct Number_Token {
+    size_t start, end;
+} Number_Token;
 
-// This structure is used to keep track of all the allocated memory that needs to be deallocated by the invoker of function.
-// The invoker can deallocate this memory using the "free_deallocation_array" function.
-typedef struct DeallocationArray {
-    unsigned size;
-    void **deallocation_array;
+// Transition lines shorter than this (in total, per thread) are read by the calling thread alone
+#define MIN_PARALLEL_READ_LENGTH (1u << 20)
 
-    unsigned regexes_size;
-    regex_t **regexes;
-} DeallocationArray;
+// A chunk of transition lines parsed by its own reader
+typedef struct Line_Chunk_Job {
+    DFA_Reader *reader;
+    const char *content;
+    size_t length;
 
-DeallocationArray make_deallocation_array();
-void free_deallocation_array(DeallocationArray d_arr);
-DeallocationArray register_memory_for_deallocation(DeallocationArray d_arr, void *ptr);
-DeallocationArray register_regex_for_deallocation(DeallocationArray d_arr, regex_t *regex_ptr);
+    // The first line of the chunk that caused an error, or NULL if there is none
+    const char *error_line;
+    size_t error_line_length;
+} Line_Chunk_Job;
 
 const char *LEADING_ZEROES_REASON = "the number should not have leading zeroes";
 
 // Helper functions declarations 
 
-int is_line_empty(const DFA_Reader *reader, const char *line);
-DeallocationArray parse_number_of_states(DFA_Reader *reader, const char *line);
-DeallocationArray parse_final_states(DFA_Reader *reader, const char *line);
-DeallocationArray parse_transition(DFA_Reader *reader, const char *line);
+// Lines are parsed in place with a single pass over their characters.
+// Nothing is allocated unless an error is reported.
+int is_line_empty(const char *line, size_t length);
+void parse_number_of_states(DFA_Reader *reader, const char *line, size_t length);
+void parse_final_states(DFA_Reader *reader, const char *line, size_t length);
+void parse_transition(DFA_Reader *reader, const char *line, size_t length);
+
+// Reads the line that starts at the given position. Returns the start of the next line, or NULL if it was the last one.
+const char *read_next_DFA_line(DFA_Reader *reader, const char *line, const char *end);
+
+// Parses the lines of the chunk until the end of the chunk or the first error
+void *read_line_chunk(void *job);
+
+// Same characters as "\s" in the POSIX locale
+int is_whitespace(char c);
+int is_digit(char c);
+size_t skip_whitespace(const char *line, size_t position, size_t length);
+
+// Reads a non-empty sequence of digits starting at the position. Returns 0 if there is none.
+int read_number_token(const char *line, size_t position, size_t length, Number_Token *token);
+
+// Returns 1 if the number has leading zeroes 
+int has_leading_zeroes(const char *line, Number_Token token);
+
+// Converts the number the same way strtoul does (saturating on overflow), truncated to unsigned
+unsigned number_token_value(const char *line, Number_Token token);
 
 // Extracts substring: source[start..end)
-char *extract_str(const char *source, int start, int end);
+char *extract_str(const char *source, size_t start, size_t end);
+
+// Error reporting helpers that copy the offending parts of the line
+void report_bad_line(DFA_Reader *reader, const char *line, size_t length, const char *expected);
+void report_bad_number(DFA_Reader *reader, const char *line, Number_Token token, const char *purpose, const char *reason);
 
-char *extract_match(const char *source, regmatch_t match);
+// Returns the slot of the transition index that holds (origin, letter), or the empty slot where it would be inserted
+unsigned find_transition_slot(const DFA_Reader *reader, unsigned origin, unsigned char letter);
 
-// Returns 1 if the string has leading zeroes 
-int is_valid_non_negative_number(const char* num);
+// Adds the transition unless it is already there. Registers an error if it conflicts with a previously added one.
+void add_reader_transition(DFA_Reader *reader, unsigned origin, unsigned destination, char letter, unsigned line_number);
+
+// Makes room for the given number of transitions, growing the buffers and the index geometrically
+void reserve_reader_transitions(DFA_Reader *reader, unsigned count);
 
 // Definitions of functions from "dfa_reader.h"
 
@@ -84,21 +117,18 @@ DFA_Reader *make_DFA_reader() {
 
     reader->final_states = NULL;
     reader->final_states_count = 0;
+    reader->final_states_capacity = 0;
 
     reader->transitions = NULL;
+    reader->transition_line_numbers = NULL;
     reader->transition_count = 0;
-    
-    int regex_errors = 0;
-    
-    regex_errors = regex_errors | regcomp(&reader->empty_re, "^\\s*$", REG_EXTENDED);
-    regex_errors = regex_errors | regcomp(&reader->number_of_states_re, "^\\s*([0-9]+)\\s*$", REG_EXTENDED);
-    regex_errors = regex_errors | regcomp(&reader->final_states_re, "^(\\s*[0-9]+)+\\s*$", REG_EXTENDED);
-    regex_errors = regex_errors | regcomp(&reader->final_states_none_re, "^\\s*NONE\\s*$", REG_EXTENDED);
-    regex_errors = regex_errors | regcomp(&reader->transition_re, "^\\s*([0-9]+)\\s*->\\s*([0-9]+)\\s*:\\s*(\\S)\\s*$", REG_EXTENDED);
-    
-    if (regex_errors) {
-        reader->error_message = dfa_reader_regex_error();
-    }
+    reader->transition_capacity = 0;
+
+    reader->transition_index = NULL;
+    reader->transition_index_capacity = 0;
+
+    reader->minimization_enabled = 0;
+    reader->allocator = (DFA_Allocator) {NULL, NULL, NULL};
     
     return reader;
 }
@@ -117,14 +147,15 @@ void delete_DFA_reader(DFA_Reader *reader) {
 
         if (reader->transitions != NULL) {
             free(reader->transitions);
+            free(reader->transition_line_numbers);
             reader->transitions = NULL;
         }
 
-        regfree(&reader->empty_re);
-        regfree(&reader->number_of_states_re);
-        regfree(&reader->final_states_none_re);
-        regfree(&reader->final_states_re);
-        regfree(&reader->transition_re);
+        if (reader->transition_index != NULL) {
+            free(reader->transition_index);
+            reader->transition_index = NULL;
+        }
+
         free(reader);
     }
 }
@@ -137,6 +168,14 @@ const char *get_error(const DFA_Reader *reader) {
     return reader->error_message;
 }
 
+void set_DFA_minimization(DFA_Reader *reader, int enabled) {
+    reader->minimization_enabled = enabled;
+}
+
+void set_DFA_reader_allocator(DFA_Reader *reader, const DFA_Allocator *allocator) {
+    reader->allocator = allocator != NULL ? *allocator : (DFA_Allocator) {NULL, NULL, NULL};
+}
+
 int can_make_DFA(const DFA_Reader *reader) {
     return has_error(reader) == 0 && reader->state == TRANSITIONS ? 1 : 0;
 }
@@ -146,23 +185,29 @@ struct DFA *finish_and_get_DFA(const DFA_Reader* reader) {
         return NULL;
     }
 
-    struct DFA *dfa = make_DFA(reader->number_of_states);
-    
-    // Enrich DFA with the final states
-    for (int i = 0; i < reader->final_states_count; i++) {
-        mark_state_as_final(dfa, reader->final_states[i]);
-    }
-
-    // Enrich DFA with transitions
-    for (int i = 0; i < reader->transition_count; i++) {
-        Transition t = reader->transitions[i];
-        add_transition(dfa, t.origin, t.destination, t.letter);
+    // Build the compiled transition table straight from the transitions read,
+    // without creating per-state transition arrays first
+    struct Compiled_DFA *compiled = build_compiled_DFA_with_allocator(
+        reader->number_of_states,
+        reader->transitions, reader->transition_count,
+        reader->final_states, reader->final_states_count,
+        &reader->allocator
+    );
+
+    if (reader->minimization_enabled) {
+        struct Compiled_DFA *minimized = minimize_compiled_DFA(compiled, NULL, NULL);
+        delete_compiled_DFA(compiled);
+        compiled = minimized;
     }
 
-    return dfa;
+    return make_DFA_from_compiled(compiled);
 }
 
 void read_DFA_line(DFA_Reader *reader, const char *line) {
+    read_DFA_line_of_length(reader, line, strlen(line));
+}
+
+void read_DFA_line_of_length(DFA_Reader *reader, const char *line, size_t length) {
     if (has_error(reader)) {
         return;
     }
@@ -170,265 +215,437 @@ void read_DFA_line(DFA_Reader *reader, const char *line) {
     ++reader->line_number;
 
     // Skip empty line
-    if (is_line_empty(reader, line)) {
+    if (is_line_empty(line, length)) {
         return;
     }
 
     switch (reader->state)
     {
     case STATE_NUMBER:
-        free_deallocation_array(parse_number_of_states(reader, line));
+        parse_number_of_states(reader, line, length);
         break;
     case FINAL_STATES:
-        free_deallocation_array(parse_final_states(reader, line));
+        parse_final_states(reader, line, length);
         break;
     case TRANSITIONS:
-        free_deallocation_array(parse_transition(reader, line));
+        parse_transition(reader, line, length);
         break;
     }
 }
 
 
-// Helper functions definitions
+void read_DFA_lines(DFA_Reader *reader, const char *content, size_t length, unsigned threads) {
+    const char *line = content, *end = content + length;
+
+    // The number of states and the final states are read by the calling thread
+    while (line != NULL && !has_error(reader) && reader->state != TRANSITIONS) {
+        line = read_next_DFA_line(reader, line, end);
+    }
+    if (line == NULL || has_error(reader)) {
+        return;
+    }
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned) online : 1;
+    }
+    size_t remaining_length = end - line;
+    if (threads > remaining_length / MIN_PARALLEL_READ_LENGTH) {
+        threads = (unsigned) (remaining_length / MIN_PARALLEL_READ_LENGTH);
+    }
+
+    if (threads <= 1) {
+        while (line != NULL && !has_error(reader)) {
+            line = read_next_DFA_line(reader, line, end);
+        }
+        return;
+    }
+
+    // Split the transition lines into chunks that end at a new line. The new line ending a chunk is not part of it,
+    // so only the last chunk ends with the part after the last new line. Each chunk reader numbers its lines
+    // starting from the line the chunk begins with.
+    Line_Chunk_Job *jobs = (Line_Chunk_Job*) malloc(threads * sizeof(Line_Chunk_Job));
+    pthread_t *workers = (pthread_t*) malloc(threads * sizeof(pthread_t));
+    int *started = (int*) calloc(threads, sizeof(int));
+    const char *transitions_start = line;
+    unsigned line_number = reader->line_number;
+
+    for (unsigned t = 0; t < threads; t++) {
+        const char *chunk_end = end;
+        if (t + 1 < threads && line != NULL) {
+            const char *split = transitions_start + (t + 1) * (remaining_length / threads);
+            split = split < line ? line : split;
+            chunk_end = (const char*) memchr(split, '\n', end - split);
+            chunk_end = chunk_end == NULL ? end : chunk_end;
+        }
 
-int is_line_empty(const DFA_Reader *reader, const char *line) {
-    return regexec(&reader->empty_re, line, 0, NULL, 0) == 0 ? 1 : 0;
+        jobs[t].reader = make_DFA_reader();
+        jobs[t].reader->state = TRANSITIONS;
+        jobs[t].reader->number_of_states = reader->number_of_states;
+        jobs[t].reader->line_number = line_number;
+        jobs[t].content = line;
+        jobs[t].length = line == NULL ? 0 : chunk_end - line;
+        jobs[t].error_line = NULL;
+
+        // Count the lines of the chunk. A chunk is empty (NULL) once the content has run out.
+        for (const char *l = line; l != NULL; ) {
+            const char *new_line = (const char*) memchr(l, '\n', chunk_end - l);
+            line_number++;
+            l = new_line == NULL ? NULL : new_line + 1;
+        }
+        line = chunk_end == end ? NULL : chunk_end + 1;
+    }
+
+    // The calling thread takes the first chunk. If a thread cannot be started, its chunk is read here as well.
+    for (unsigned t = 1; t < threads; t++) {
+        started[t] = pthread_create(&workers[t], NULL, read_line_chunk, &jobs[t]) == 0;
+    }
+    read_line_chunk(&jobs[0]);
+    for (unsigned t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(workers[t], NULL);
+        } else {
+            read_line_chunk(&jobs[t]);
+        }
+    }
+
+    // Merge the chunks in order. Conflicts between chunks are found while adding the transitions of a chunk,
+    // in the order of their lines. If the chunk has an error, its line is read again once all the transitions
+    // before it are merged, so the error (e.g. a conflict with an earlier chunk) is reported as in a serial read.
+    unsigned total_count = reader->transition_count;
+    for (unsigned t = 0; t < threads; t++) {
+        total_count += jobs[t].reader->transition_count;
+    }
+    reserve_reader_transitions(reader, total_count);
+
+    for (unsigned t = 0; t < threads && !has_error(reader); t++) {
+        DFA_Reader *chunk_reader = jobs[t].reader;
+        for (unsigned i = 0; i < chunk_reader->transition_count && !has_error(reader); i++) {
+            const DFA_Edge *edge = &chunk_reader->transitions[i];
+            add_reader_transition(reader, edge->origin, edge->destination, (char) edge->letter, chunk_reader->transition_line_numbers[i]);
+        }
+
+        if (!has_error(reader) && jobs[t].error_line != NULL) {
+            reader->line_number = chunk_reader->line_number - 1;
+            read_DFA_line_of_length(reader, jobs[t].error_line, jobs[t].error_line_length);
+        }
+        reader->line_number = chunk_reader->line_number;
+    }
+
+    for (unsigned t = 0; t < threads; t++) {
+        delete_DFA_reader(jobs[t].reader);
+    }
+    free(jobs);
+    free(workers);
+    free(started);
 }
 
+// Helper functions definitions
 
-DeallocationArray parse_number_of_states(DFA_Reader *reader, const char *line) {
-    DeallocationArray d_arr = make_deallocation_array();
+int is_line_empty(const char *line, size_t length) {
+    return skip_whitespace(line, 0, length) == length ? 1 : 0;
+}
+
+// Accepts: ^\s*([0-9]+)\s*$
+void parse_number_of_states(DFA_Reader *reader, const char *line, size_t length) {
     reader->state = FINAL_STATES;
 
-    // If number of states regular expression did not match
-    if (regexec(&reader->number_of_states_re, line, 0, NULL, 0)) {
-        reader->error_message = dfa_reader_bad_line_error(reader->line_number, line, "number of state");
-        return d_arr;
+    Number_Token number;
+    if (!read_number_token(line, skip_whitespace(line, 0, length), length, &number)
+        || skip_whitespace(line, number.end, length) != length) {
+        report_bad_line(reader, line, length, "number of state");
+        return;
     }
 
-    regmatch_t groups[2];
-    regexec(&reader->number_of_states_re, line, 2, groups, 0);
-    char *extracted_number = extract_str(line, groups[1].rm_so, groups[1].rm_eo);
-    d_arr = register_memory_for_deallocation(d_arr, extracted_number);
-
     // If the number is invalid, register error and return
-    if (is_valid_non_negative_number(extracted_number) == 0) {
-        reader->error_message = dfa_reader_bad_number_error(reader->line_number, extracted_number, "number of states", LEADING_ZEROES_REASON);
-        return d_arr;
+    if (has_leading_zeroes(line, number)) {
+        report_bad_number(reader, line, number, "number of states", LEADING_ZEROES_REASON);
+        return;
     }
 
     // Check that the number is valid (i.e. greater than zero) and return
-    reader->number_of_states = strtoul(extracted_number, NULL, 10);
+    reader->number_of_states = number_token_value(line, number);
     if (reader->number_of_states == 0) {
-        reader->error_message = dfa_reader_bad_number_error(reader->line_number, extracted_number, "number of states", "must be greater than 0");
+        report_bad_number(reader, line, number, "number of states", "must be greater than 0");
     }
-    return d_arr;
 }
 
-DeallocationArray parse_final_states(DFA_Reader *reader, const char *line) {
-    DeallocationArray d_arr = make_deallocation_array();
+// Accepts: ^\s*NONE\s*$ or ^(\s*[0-9]+)+\s*$
+void parse_final_states(DFA_Reader *reader, const char *line, size_t length) {
+    size_t first = skip_whitespace(line, 0, length);
+    int is_none = length - first >= 4 && strncmp(line + first, "NONE", 4) == 0
+        && skip_whitespace(line, first + 4, length) == length;
 
-    int outcome_for_none = regexec(&reader->final_states_none_re, line, 0, NULL, 0);
-    int outcome_for_fs = regexec(&reader->final_states_re, line, 0, NULL, 0);
+    int has_digits = 0, has_only_digits = 1;
+    for (size_t i = 0; i < length && !is_none; i++) {
+        has_digits = has_digits || is_digit(line[i]);
+        has_only_digits = has_only_digits && (is_digit(line[i]) || is_whitespace(line[i]));
+    }
 
-    if (outcome_for_fs != 0 && outcome_for_none != 0) {
-        reader->error_message = dfa_reader_bad_line_error(reader->line_number, line, "final states descriptor");
-        return d_arr;
+    if (!is_none && !(has_digits && has_only_digits)) {
+        report_bad_line(reader, line, length, "final states descriptor");
+        return;
     }
 
     reader->state = TRANSITIONS;
-    if (outcome_for_none == 0) {
-        return d_arr;
+    if (is_none) {
+        return;
     }
 
-    reader->final_states = malloc(0);
-
-    regex_t *number_re = malloc(sizeof(regex_t));
-    regcomp(number_re, "[0-9]+", REG_EXTENDED);
-    d_arr = register_regex_for_deallocation(d_arr, number_re);
-
-
-    int start_offset = 0;
-    regmatch_t groups[1];
-    
-    while (!regexec(number_re, &line[start_offset], 1, groups, 0)) {
-        char *extracted_num = extract_match(&line[start_offset], groups[0]);
-        d_arr = register_memory_for_deallocation(d_arr, extracted_num);
-        
+    Number_Token number;
+    size_t position = skip_whitespace(line, 0, length);
+    while (read_number_token(line, position, length, &number)) {
         // If final state number is not valid
-        if (!is_valid_non_negative_number(extracted_num)) {
-            reader->error_message = dfa_reader_bad_number_error(reader->line_number, extracted_num, "final state", LEADING_ZEROES_REASON);
-            return d_arr;
-        } 
-        
-        unsigned state_id = strtoul(extracted_num, NULL, 10);
+        if (has_leading_zeroes(line, number)) {
+            report_bad_number(reader, line, number, "final state", LEADING_ZEROES_REASON);
+            return;
+        }
+
+        unsigned state_id = number_token_value(line, number);
         // If final state is out of bounds
         if (reader->number_of_states <= state_id) {
             reader->error_message = dfa_reader_state_out_of_bounds_error(reader->line_number, state_id, reader->number_of_states);
-            return d_arr;
+            return;
         }
 
         // Otherwise, add final state
-        reader->final_states = realloc(reader->final_states, ++reader->final_states_count * sizeof(unsigned));
-        reader->final_states[reader->final_states_count-1] = state_id;
-        start_offset += groups[0].rm_eo;
-    }
-
-    // Before completing, ensure that there are no repeating states in the final states sequence
-    for (int i = 0; i < reader->final_states_count; i++) {
-        for (int k = i + 1; k < reader->final_states_count; k++) {
-            if (reader->final_states[i] == reader->final_states[k]) {
-                reader->error_message = dfa_reader_repeating_final_state_error(reader->line_number, reader->final_states[i]);
-                return d_arr;
-            }
+        if (reader->final_states_count == reader->final_states_capacity) {
+            reader->final_states_capacity = reader->final_states_capacity == 0 ? 8 : 2 * reader->final_states_capacity;
+            reader->final_states = realloc(reader->final_states, reader->final_states_capacity * sizeof(unsigned));
         }
+        reader->final_states[reader->final_states_count++] = state_id;
+        position = skip_whitespace(line, number.end, length);
     }
 
-    return d_arr;
+    // Before completing, ensure that there are no repeating states in the final states sequence.
+    // The reported state is the first one in the sequence that appears again later.
+    unsigned char *occurrences = (unsigned char*) calloc(reader->number_of_states, sizeof(unsigned char));
+    for (unsigned i = 0; i < reader->final_states_count; i++) {
+        if (occurrences[reader->final_states[i]] < 2) {
+            occurrences[reader->final_states[i]]++;
+        }
+    }
+    for (unsigned i = 0; i < reader->final_states_count; i++) {
+        if (occurrences[reader->final_states[i]] > 1) {
+            reader->error_message = dfa_reader_repeating_final_state_error(reader->line_number, reader->final_states[i]);
+            break;
+        }
+    }
+    free(occurrences);
 }
 
+// Accepts: ^\s*([0-9]+)\s*->\s*([0-9]+)\s*:\s*(\S)\s*$
+void parse_transition(DFA_Reader *reader, const char *line, size_t length) {
+    Number_Token origin, destination;
+    size_t position = skip_whitespace(line, 0, length);
+    int is_valid = read_number_token(line, position, length, &origin);
 
-DeallocationArray parse_transition(DFA_Reader *reader, const char *line) {
-    DeallocationArray d_arr = make_deallocation_array();
-    if (regexec(&reader->transition_re, line, 0, NULL, 0)) {
-        reader->error_message = dfa_reader_bad_line_error(reader->line_number, line, "a valid transition descriptor");
-        return d_arr;
+    if (is_valid) {
+        position = skip_whitespace(line, origin.end, length);
+        is_valid = length - position >= 2 && line[position] == '-' && line[position + 1] == '>';
     }
-    
-    regmatch_t groups[4];
-    regexec(&reader->transition_re, line, 4, groups, 0);
-
-    char *origin = extract_match(line, groups[1]);
-    char *destination = extract_match(line, groups[2]);
-    char *letters = extract_match(line, groups[3]);
-    d_arr = register_memory_for_deallocation(d_arr, origin);
-    d_arr = register_memory_for_deallocation(d_arr, destination);
-    d_arr = register_memory_for_deallocation(d_arr, letters);
+    if (is_valid) {
+        is_valid = read_number_token(line, skip_whitespace(line, position + 2, length), length, &destination);
+    }
+    if (is_valid) {
+        position = skip_whitespace(line, destination.end, length);
+        is_valid = position < length && line[position] == ':';
+    }
+    if (is_valid) {
+        position = skip_whitespace(line, position + 1, length);
+        is_valid = position < length && !is_whitespace(line[position]) && skip_whitespace(line, position + 1, length) == length;
+    }
+    if (!is_valid) {
+        report_bad_line(reader, line, length, "a valid transition descriptor");
+        return;
+    }
+    char letter = line[position];
 
     // Check that the "origin" state in the transition has no leading zeroes
-    if (!is_valid_non_negative_number(origin)) {
-        reader->error_message = dfa_reader_bad_number_error(reader->line_number, origin, "origin state of transition", LEADING_ZEROES_REASON);
-        return d_arr;
+    if (has_leading_zeroes(line, origin)) {
+        report_bad_number(reader, line, origin, "origin state of transition", LEADING_ZEROES_REASON);
+        return;
     }
     
-    unsigned origin_state_id = strtoul(origin, NULL, 10);
+    unsigned origin_state_id = number_token_value(line, origin);
 
     // Check that the "origin" state in the transition is within state ID bounds
     if (reader->number_of_states <= origin_state_id) {
         reader->error_message = dfa_reader_state_out_of_bounds_error(reader->line_number, origin_state_id, reader->number_of_states);
-        return d_arr;
+        return;
     }
 
     // Check that the "destination" state in the transition has no leading zeroes
-    if (!is_valid_non_negative_number(destination)) {
-        reader->error_message = dfa_reader_bad_number_error(reader->line_number, destination, "destination state of transition", LEADING_ZEROES_REASON);
-        return d_arr;
+    if (has_leading_zeroes(line, destination)) {
+        report_bad_number(reader, line, destination, "destination state of transition", LEADING_ZEROES_REASON);
+        return;
     }
     
-    unsigned destination_state_id = strtoul(destination, NULL, 10);
+    unsigned destination_state_id = number_token_value(line, destination);
 
     // Check that the "destination" state in the transition is within state ID bounds
     if (reader->number_of_states <= destination_state_id) {
         reader->error_message = dfa_reader_state_out_of_bounds_error(reader->line_number, destination_state_id, reader->number_of_states);
-        return d_arr;
+        return;
     }
 
-    Transition t;
-    t.origin = origin_state_id;
-    t.destination = destination_state_id;
-    t.letter = letters[0];
-    t.line_number = reader->line_number;
+    add_reader_transition(reader, origin_state_id, destination_state_id, letter, reader->line_number);
+}
 
+void add_reader_transition(DFA_Reader *reader, unsigned origin, unsigned destination, char letter, unsigned line_number) {
     // Check that this transition does not have a conflict with any other previously added transition
     // Conflict is when the two transitions have same origin state and transition letter, but different destination state.
     // Note that this conflict only applies to DFA, but not NFA.
-    for (int i = 0; i < reader->transition_count; i++) {
-        
-        // Same origin & letter -- this is either a conflict or a duplication
-        // - If it is a conflict we register the error
-        // - If it is a duplication, we ignore this transition as it is already defined
-        // Either way we can stop the check and return.
-        if (t.origin == reader->transitions[i].origin && t.letter == reader->transitions[i].letter) {
-
-            // If it is a conflict, raise an error
-            if (t.destination != reader->transitions[i].destination) {
-                Transition prev = reader->transitions[i];
-                reader->error_message = dfa_reader_conflicting_transitions_error(
-                    prev.line_number, t.line_number, prev.destination, t.destination, t.origin, t.letter
-                );
-            }
-            return d_arr;
+    reserve_reader_transitions(reader, reader->transition_count + 1);
+    unsigned slot = find_transition_slot(reader, origin, (unsigned char) letter);
+
+    // Same origin & letter -- this is either a conflict or a duplication
+    // - If it is a conflict we register the error
+    // - If it is a duplication, we ignore this transition as it is already defined
+    if (reader->transition_index[slot] != 0) {
+        unsigned previous = reader->transition_index[slot] - 1;
+
+        // If it is a conflict, raise an error
+        if (destination != reader->transitions[previous].destination) {
+            reader->error_message = dfa_reader_conflicting_transitions_error(
+                reader->transition_line_numbers[previous], line_number,
+                reader->transitions[previous].destination, destination, origin, letter
+            );
         }
+        return;
     }
 
     // All ok, add transition
-    reader->transitions = realloc(reader->transitions, ++reader->transition_count * sizeof(Transition));
-    reader->transitions[reader->transition_count - 1] = t;
+    DFA_Edge *edge = &reader->transitions[reader->transition_count];
+    edge->origin = origin;
+    edge->destination = destination;
+    edge->letter = (unsigned char) letter;
+    reader->transition_line_numbers[reader->transition_count] = line_number;
+    reader->transition_index[slot] = ++reader->transition_count;
+}
 
-    return d_arr;
+const char *read_next_DFA_line(DFA_Reader *reader, const char *line, const char *end) {
+    const char *new_line = (const char*) memchr(line, '\n', end - line);
+    if (new_line == NULL) {
+        read_DFA_line_of_length(reader, line, end - line);
+        return NULL;
+    }
+    read_DFA_line_of_length(reader, line, new_line - line);
+    return new_line + 1;
 }
 
-// Helper functions definitions
+void *read_line_chunk(void *job_ptr) {
+    Line_Chunk_Job *job = (Line_Chunk_Job*) job_ptr;
+    const char *line = job->content, *end = job->content + job->length;
 
-char *extract_match(const char *source, regmatch_t match) {
-    return extract_str(source, match.rm_so, match.rm_eo);
+    while (line != NULL) {
+        const char *next = read_next_DFA_line(job->reader, line, end);
+        if (has_error(job->reader)) {
+            job->error_line = line;
+            job->error_line_length = (next == NULL ? end : next - 1) - line;
+            break;
+        }
+        line = next;
+    }
+    return NULL;
 }
 
-char *extract_str(const char *source, int start, int end) {
-    unsigned length = end - start;
-    char *extracted_string = (char*) calloc(length + 10, sizeof(char));
-    strncpy(extracted_string, source + start, length);
-    return extracted_string;
+int is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
 }
 
-int is_valid_non_negative_number(const char* num) {
-    regex_t regex;
-    regcomp(&regex, "^(0|[1-9][0-9]*)$", REG_EXTENDED);
-    int is_valid = regexec(&regex, num, 0, NULL, 0) == 0 ? 1 : 0;
-    regfree(&regex);
-    return is_valid;
+int is_digit(char c) {
+    return '0' <= c && c <= '9';
 }
 
-// Deallocation array functions
+size_t skip_whitespace(const char *line, size_t position, size_t length) {
+    while (position < length && is_whitespace(line[position])) {
+        position++;
+    }
+    return position;
+}
 
-DeallocationArray make_deallocation_array() {
-    DeallocationArray d_arr;
+int read_number_token(const char *line, size_t position, size_t length, Number_Token *token) {
+    token->start = position;
+    while (position < length && is_digit(line[position])) {
+        position++;
+    }
+    token->end = position;
+    return token->end > token->start;
+}
 
-    d_arr.size = 0;
-    d_arr.deallocation_array = NULL;
+int has_leading_zeroes(const char *line, Number_Token token) {
+    return token.end - token.start > 1 && line[token.start] == '0';
+}
 
-    d_arr.regexes_size = 0;
-    d_arr.regexes = NULL;
-    
-    return d_arr;
+unsigned number_token_value(const char *line, Number_Token token) {
+    unsigned long value = 0;
+    for (size_t i = token.start; i < token.end; i++) {
+        unsigned long digit = line[i] - '0';
+        if (value > (-1UL - digit) / 10) {
+            value = -1UL;
+            break;
+        }
+        value = value * 10 + digit;
+    }
+    return (unsigned) value;
 }
 
-void free_deallocation_array(DeallocationArray d_arr) {
-    
-    for (unsigned i = 0; i < d_arr.size; i++) {
-        free(d_arr.deallocation_array[i]);
+char *extract_str(const char *source, size_t start, size_t end) {
+    size_t length = end - start;
+    char *extracted_string = (char*) calloc(length + 1, sizeof(char));
+    memcpy(extracted_string, source + start, length);
+    return extracted_string;
+}
+
+void report_bad_line(DFA_Reader *reader, const char *line, size_t length, const char *expected) {
+    char *line_copy = extract_str(line, 0, length);
+    reader->error_message = dfa_reader_bad_line_error(reader->line_number, line_copy, expected);
+    free(line_copy);
+}
+
+void report_bad_number(DFA_Reader *reader, const char *line, Number_Token token, const char *purpose, const char *reason) {
+    char *number = extract_str(line, token.start, token.end);
+    reader->error_message = dfa_reader_bad_number_error(reader->line_number, number, purpose, reason);
+    free(number);
+}
+
+unsigned find_transition_slot(const DFA_Reader *reader, unsigned origin, unsigned char letter) {
+    unsigned long long key = (unsigned long long) origin * DFA_ALPHABET_SIZE + letter;
+    unsigned mask = reader->transition_index_capacity - 1;
+    unsigned slot = (unsigned) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+
+    while (reader->transition_index[slot] != 0) {
+        const DFA_Edge *edge = &reader->transitions[reader->transition_index[slot] - 1];
+        if (edge->origin == origin && edge->letter == letter) {
+            break;
+        }
+        slot = (slot + 1) & mask;
     }
+    return slot;
+}
 
-    for (unsigned i = 0; i < d_arr.regexes_size; i++) {
-        regfree(d_arr.regexes[i]);
-        free(d_arr.regexes[i]);
+void reserve_reader_transitions(DFA_Reader *reader, unsigned count) {
+    if (count > reader->transition_capacity) {
+        while (count > reader->transition_capacity) {
+            reader->transition_capacity = reader->transition_capacity == 0 ? 64 : 2 * reader->transition_capacity;
+        }
+        reader->transitions = realloc(reader->transitions, reader->transition_capacity * sizeof(DFA_Edge));
+        reader->transition_line_numbers = realloc(reader->transition_line_numbers, reader->transition_capacity * sizeof(unsigned));
     }
-    if (d_arr.deallocation_array != NULL) {
-        free(d_arr.deallocation_array);
+
+    // The index is kept at most half full
+    if (2ULL * count <= reader->transition_index_capacity) {
+        return;
     }
-    if (d_arr.regexes != NULL) {
-        free(d_arr.regexes);
+    while (2ULL * count > reader->transition_index_capacity) {
+        reader->transition_index_capacity = reader->transition_index_capacity == 0 ? 128 : 2 * reader->transition_index_capacity;
     }
-}
+    free(reader->transition_index);
+    reader->transition_index = (unsigned*) calloc(reader->transition_index_capacity, sizeof(unsigned));
 
-DeallocationArray register_memory_for_deallocation(DeallocationArray d_arr, void *ptr) {
-    d_arr.deallocation_array = (void**) realloc(d_arr.deallocation_array, (++d_arr.size) * sizeof(void*));
-    d_arr.deallocation_array[d_arr.size-1] = ptr;
-    return d_arr;
+    for (unsigned i = 0; i < reader->transition_count; i++) {
+        const DFA_Edge *edge = &reader->transitions[i];
+        reader->transition_index[find_transition_slot(reader, edge->origin, edge->letter)] = i + 1;
+    }
 }
-
-DeallocationArray register_regex_for_deallocation(DeallocationArray d_arr, regex_t *regex_ptr) {
-    d_arr.regexes = (regex_t**) realloc(d_arr.regexes, (++d_arr.regexes_size) * sizeof(regex_t*));
-    d_arr.regexes[d_arr.regexes_size-1] = regex_ptr;
-    return d_arr;
-}
\ No newline at end of file
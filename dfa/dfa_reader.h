@@ -1,4 +1,3 @@
-#include <regex.h>
 #include "dfa.h"
 
 struct DFA_Reader;
@@ -18,6 +17,13 @@ const char *get_error(const struct DFA_Reader*);
 // Returns 1 if the information read so far can produce a DFA
 int can_make_DFA(const struct DFA_Reader*);
 
+// Makes finish_and_get_DFA return the minimized DFA (see minimize_DFA) when enabled is non-zero
+void set_DFA_minimization(struct DFA_Reader*, int enabled);
+
+// Makes finish_and_get_DFA allocate the DFA from the given allocator (see dfa_allocator.h); NULL restores the default.
+// The reader's own memory does not come from it.
+void set_DFA_reader_allocator(struct DFA_Reader*, const struct DFA_Allocator*);
+
 // Returns a DFA based on the lines read.
 // If DFA cannot be constructed based on the lines provided (either because some information is missing or because error was detected)
 // NULL is returned.
@@ -25,3 +31,13 @@ struct DFA *finish_and_get_DFA(const struct DFA_Reader*);
 
 // DFA Reader reads a line that describes DFA
 void read_DFA_line(struct DFA_Reader*, const char *line);
+
+// Same as read_DFA_line, but the line is given by its first character and length and need not be NUL-terminated.
+// This lets callers pass lines straight out of a larger buffer (e.g. a mapped file) without copying them.
+void read_DFA_line_of_length(struct DFA_Reader*, const char *line, size_t length);
+
+// Reads every line of the content; lines are separated by '\n' and the part after the last one is a line as well.
+// The transition lines are split into chunks at line boundaries and parsed by the given number of threads
+// (0 stands for the number of online processors). The result, including the error reported, is the same as
+// when the lines are read one by one with read_DFA_line.
+void read_DFA_lines(struct DFA_Reader*, const char *content, size_t length, unsigned threads);
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "errors.h"
+#include "dfa_regex.h"
+#include "regex_nfa.h"
+#include "compiled_dfa.h"
+
+// Largest DFA (before minimization) built from a regular expression
+#define REGEX_DFA_STATE_LIMIT (1u << 16)
+
+// Helper functions declarations
+
+struct DFA *regex_compilation_error(char *error_message, int enabled_error_printing);
+
+// Definitions of functions from "dfa_regex.h"
+
+struct DFA *make_DFA_from_regex(const char *pattern, int enabled_error_printing) {
+    char *error_message;
+    struct Regex_NFA *nfa = make_regex_NFA(pattern, &error_message);
+    if (nfa == NULL) {
+        return regex_compilation_error(error_message, enabled_error_printing);
+    }
+
+    // Every subset reachable from the start one becomes a state. The subsets are numbered in the order
+    // they are found, so going through them in order visits every new one.
+    struct Subset_Builder *builder = make_subset_builder(nfa);
+    for (unsigned subset = 0; subset < get_number_of_subsets(builder); subset++) {
+        if (get_number_of_subsets(builder) > REGEX_DFA_STATE_LIMIT) {
+            delete_subset_builder(builder);
+            delete_regex_NFA(nfa);
+            return regex_compilation_error(regex_too_many_states_error(REGEX_DFA_STATE_LIMIT), enabled_error_printing);
+        }
+        for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+            get_subset_transition(builder, subset, (unsigned char) letter);
+        }
+    }
+
+    // The empty subset is left out of the edges, so it ends up as the garbage state
+    unsigned number_of_states = get_number_of_subsets(builder);
+    DFA_Edge *edges = (DFA_Edge*) malloc(((size_t) number_of_states * DFA_ALPHABET_SIZE + 1) * sizeof(DFA_Edge));
+    unsigned *final_states = (unsigned*) malloc((number_of_states + 1) * sizeof(unsigned));
+    unsigned edge_count = 0, final_states_count = 0;
+    for (unsigned subset = 0; subset < number_of_states; subset++) {
+        if (is_subset_final(builder, subset)) {
+            final_states[final_states_count++] = subset;
+        }
+        for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+            unsigned destination = get_subset_transition(builder, subset, (unsigned char) letter);
+            if (!is_subset_empty(builder, destination)) {
+                edges[edge_count].origin = subset;
+                edges[edge_count].destination = destination;
+                edges[edge_count].letter = (unsigned char) letter;
+                edge_count++;
+            }
+        }
+    }
+    delete_subset_builder(builder);
+    delete_regex_NFA(nfa);
+
+    struct Compiled_DFA *compiled = build_compiled_DFA(number_of_states, edges, edge_count, final_states, final_states_count);
+    free(edges);
+    free(final_states);
+
+    struct Compiled_DFA *minimized = minimize_compiled_DFA(compiled, NULL, NULL);
+    delete_compiled_DFA(compiled);
+    return make_DFA_from_compiled(minimized);
+}
+
+// Helper functions definitions
+
+struct DFA *regex_compilation_error(char *error_message, int enabled_error_printing) {
+    if (enabled_error_printing) {
+        printf("%s\n", error_message);
+    }
+    free(error_message);
+    return NULL;
+}
@@ -0,0 +1,10 @@
+#include "dfa.h"
+
+// Compiles the regular expression into the minimal DFA that ACCEPTS exactly the words the whole expression matches.
+// The expression is made of letters and:
+//   (...) groups, | alternation, * + ? {m} {m,} {m,n} repetition,
+//   . any letter, [abc] [a-z] [^...] letter sets,
+//   \d \D \w \W \s \S letter classes, \n \t \r \f \v \xHH letters, and \ before any other letter for the letter itself.
+// Returns NULL if the expression is invalid or its DFA would be too large (see make_lazy_DFA_from_regex).
+// Pass a non-zero integer for the second parameter to enable printing of errors (in case of any)
+struct DFA *make_DFA_from_regex(const char *pattern, int enabled_error_printing);
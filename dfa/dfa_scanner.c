@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <string.h>
+#include "dfa_scanner.h"
+#include "compiled_dfa.h"
+
+// Returned by the match loops when no match starts at the position
+#define NO_MATCH ((size_t) -1)
+
+// Number of matches handed to the callback at a time
+#define SCAN_BATCH_SIZE 64
+
+// Number of positions after its start for which an attempt remembers its states (a power of 2)
+#define SCAN_MEMO_SIZE 4096
+
+// Attempts that read more letters than this make the following attempts remember their states
+#define SCAN_MEMO_THRESHOLD 64
+
+// States that attempts were in after reading the letters before the position.
+// An attempt that finds the state of an earlier attempt at the same position follows its path from there on.
+// That path has no final states after the position, unless it is a match which the later attempt starts after,
+// so the later attempt can stop.
+typedef struct Scan_Memo_Entry {
+    size_t position;
+    unsigned long long low_states; // one bit per state below 64
+    size_t high_state_id;          // the last state of 64 or above, or NO_MATCH
+} Scan_Memo_Entry;
+
+// Memory of the states of attempts, by position modulo SCAN_MEMO_SIZE
+typedef struct Scan_Memo {
+    Scan_Memo_Entry *entries; // NULL until an attempt reads far
+    size_t remembered_until;  // attempts that start before this are remembered
+} Scan_Memo;
+
+// Match loops specialized for every state ID width.
+// They run the DFA from state 0 at the start position and return the end of the earliest or the longest match,
+// or NO_MATCH, and set *reach to the position after the last letter read. A dead state ends the run, and the
+// self-loop runs of non-final states are skipped as in advance_compiled_DFA; those of final states only in
+// the longest mode, where the whole run belongs to the match. If memo is not NULL, the run also ends on a state
+// that an earlier attempt was in, and its own states are remembered.
+#define DEFINE_MATCH_LOOP(NAME, STATE_ID_TYPE)                                                     \
+static size_t NAME(                                                                                \
+    const Compiled_DFA *compiled, const unsigned char *letters, size_t start, size_t length, int longest, \
+    Scan_Memo_Entry *memo, size_t *reach                                                           \
+) {                                                                                                \
+    const STATE_ID_TYPE *transitions = (const STATE_ID_TYPE*) compiled->transitions;              \
+    const unsigned char *letter_classes = compiled->letter_classes;                                \
+    const unsigned char *state_flags = compiled->state_flags;                                      \
+    const unsigned long long *final_states = compiled->final_states;                               \
+    size_t number_of_classes = compiled->number_of_classes;                                        \
+    size_t current_state_id = 0, match_end = NO_MATCH;                                             \
+    size_t i = start;                                                                              \
+    size_t memo_end = memo == NULL ? start : start + SCAN_MEMO_SIZE;                               \
+    while (i < length) {                                                                           \
+        size_t next_state_id = transitions[current_state_id * number_of_classes + letter_classes[letters[i++]]]; \
+        int is_final = (final_states[next_state_id / 64] >> (next_state_id % 64)) & 1;           \
+        if (is_final) {                                                                            \
+            match_end = i;                                                                         \
+            if (!longest) {                                                                        \
+                break;                                                                             \
+            }                                                                                      \
+        }                                                                                          \
+        if (i <= memo_end && remember_state(memo, i, next_state_id)) {                             \
+            break;                                                                                 \
+        }                                                                                          \
+        if (state_flags[next_state_id]) {                                                          \
+            if (state_flags[next_state_id] & DFA_STATE_DEAD) {                                     \
+                break;                                                                             \
+            }                                                                                      \
+            if (next_state_id == current_state_id) {                                               \
+                const Self_Loop_Set *set = &compiled->self_loops[compiled->self_loop_index[next_state_id]]; \
+                size_t run_start = i;                                                              \
+                i = compiled->skip_self_loops(set, letters, i, length);                            \
+                match_end = is_final ? i : match_end;                                              \
+                for (size_t position = run_start + 1; position <= i && position <= memo_end; position++) { \
+                    remember_state(memo, position, next_state_id);                                 \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+        current_state_id = next_state_id;                                                          \
+    }                                                                                              \
+    *reach = i;                                                                                    \
+    return match_end;                                                                              \
+}
+
+// Remembers the state at the position. Returns 1 if it was already remembered, otherwise 0.
+static int remember_state(Scan_Memo_Entry *memo, size_t position, size_t state_id) {
+    Scan_Memo_Entry *entry = &memo[position % SCAN_MEMO_SIZE];
+    if (entry->position != position) {
+        entry->position = position;
+        entry->low_states = 0;
+        entry->high_state_id = NO_MATCH;
+    }
+    if (state_id < 64) {
+        int is_remembered = (entry->low_states >> state_id) & 1;
+        entry->low_states |= 1ULL << state_id;
+        return is_remembered;
+    }
+    int is_remembered = entry->high_state_id == state_id;
+    entry->high_state_id = state_id;
+    return is_remembered;
+}
+
+DEFINE_MATCH_LOOP(match_8, unsigned char)
+DEFINE_MATCH_LOOP(match_16, unsigned short)
+DEFINE_MATCH_LOOP(match_32, unsigned)
+
+// Helper functions declarations
+
+// Finds the matches of input[*position..length) until the array is full (see scan_DFA_into).
+// The memo is kept between the calls for the same input.
+size_t scan_compiled_DFA(
+    const Compiled_DFA *compiled, const Self_Loop_Set *non_starting_letters, const unsigned char *letters, size_t length,
+    int longest, Scan_Memo *memo, size_t *position, DFA_Match *matches, size_t capacity
+);
+
+// Collects the letters that lead from state 0 to a dead state, so no match can start with them
+void find_non_starting_letters(const Compiled_DFA *compiled, Self_Loop_Set *set);
+
+// Definitions of functions from "dfa_scanner.h"
+
+size_t scan_DFA(struct DFA *dfa, const char *input, size_t length, DFA_Match_Mode mode, DFA_Match_Callback callback, void *context) {
+    const Compiled_DFA *compiled = get_compiled_DFA(dfa);
+    Self_Loop_Set non_starting_letters;
+    find_non_starting_letters(compiled, &non_starting_letters);
+
+    DFA_Match matches[SCAN_BATCH_SIZE];
+    Scan_Memo memo = {NULL, 0};
+    size_t position = 0, reported = 0;
+    int is_stopped = 0;
+    while (position < length && !is_stopped) {
+        size_t count = scan_compiled_DFA(
+            compiled, &non_starting_letters, (const unsigned char*) input, length,
+            mode == DFA_LONGEST_MATCH, &memo, &position, matches, SCAN_BATCH_SIZE
+        );
+        for (size_t i = 0; i < count && !is_stopped; i++) {
+            reported++;
+            is_stopped = !callback(&matches[i], context);
+        }
+    }
+    free(memo.entries);
+    return reported;
+}
+
+size_t scan_DFA_into(
+    struct DFA *dfa, const char *input, size_t length, DFA_Match_Mode mode,
+    size_t *position, DFA_Match *matches, size_t capacity
+) {
+    const Compiled_DFA *compiled = get_compiled_DFA(dfa);
+    Self_Loop_Set non_starting_letters;
+    find_non_starting_letters(compiled, &non_starting_letters);
+
+    Scan_Memo memo = {NULL, 0};
+    size_t count = scan_compiled_DFA(
+        compiled, &non_starting_letters, (const unsigned char*) input, length,
+        mode == DFA_LONGEST_MATCH, &memo, position, matches, capacity
+    );
+    free(memo.entries);
+    return count;
+}
+
+// Helper functions definitions
+
+size_t scan_compiled_DFA(
+    const Compiled_DFA *compiled, const Self_Loop_Set *non_starting_letters, const unsigned char *letters, size_t length,
+    int longest, Scan_Memo *memo, size_t *position, DFA_Match *matches, size_t capacity
+) {
+    size_t start = *position, count = 0;
+    while (count < capacity) {
+        start = compiled->skip_self_loops(non_starting_letters, letters, start, length);
+        if (start >= length) {
+            break;
+        }
+
+        size_t match_end, reach;
+        Scan_Memo_Entry *attempt_memo = start < memo->remembered_until ? memo->entries : NULL;
+        switch (compiled->state_id_width) {
+        case 1:
+            match_end = match_8(compiled, letters, start, length, longest, attempt_memo, &reach);
+            break;
+        case 2:
+            match_end = match_16(compiled, letters, start, length, longest, attempt_memo, &reach);
+            break;
+        default:
+            match_end = match_32(compiled, letters, start, length, longest, attempt_memo, &reach);
+            break;
+        }
+
+        // An attempt that read far past where the next one starts would otherwise be repeated by the next ones
+        size_t next_start = match_end == NO_MATCH ? start + 1 : match_end;
+        if (reach > next_start + SCAN_MEMO_THRESHOLD && reach > memo->remembered_until) {
+            if (memo->entries == NULL) {
+                memo->entries = (Scan_Memo_Entry*) malloc(SCAN_MEMO_SIZE * sizeof(Scan_Memo_Entry));
+                memset(memo->entries, 0xFF, SCAN_MEMO_SIZE * sizeof(Scan_Memo_Entry));
+            }
+            memo->remembered_until = reach;
+        }
+
+        if (match_end == NO_MATCH) {
+            start++;
+            continue;
+        }
+        matches[count].start = start;
+        matches[count].end = match_end;
+        count++;
+        start = match_end;
+    }
+
+    *position = start < length ? start : length;
+    return count;
+}
+
+void find_non_starting_letters(const Compiled_DFA *compiled, Self_Loop_Set *set) {
+    *set = (Self_Loop_Set) {0};
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        if (is_compiled_state_dead(compiled, get_compiled_transition(compiled, 0, (unsigned char) letter))) {
+            add_letter_to_self_loop_set(set, (unsigned char) letter);
+        }
+    }
+}
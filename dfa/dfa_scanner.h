@@ -0,0 +1,40 @@
+#ifndef DFA_SCANNER_H
+#define DFA_SCANNER_H
+
+#include <stddef.h>
+#include "dfa.h"
+
+// Which match is reported when several matches start at the same position
+typedef enum DFA_Match_Mode {
+    DFA_EARLIEST_MATCH, // the shortest one: the scan stops at the first final state
+    DFA_LONGEST_MATCH   // the longest one: the scan goes on until a dead state or the end of the input
+} DFA_Match_Mode;
+
+// A match is the part input[start..end) that the DFA ACCEPTS
+typedef struct DFA_Match {
+    size_t start, end;
+} DFA_Match;
+
+// Called for every match found. Return 1 to continue scanning, 0 to stop.
+typedef int (*DFA_Match_Callback)(const DFA_Match *match, void *context);
+
+// Finds non-overlapping, non-empty matches from left to right. A match is looked for at every position from
+// the left, and once one is found the scan restarts from the state 0 right after it, as a lexer does.
+// Positions that no match can start at are skipped in bulk. Once an attempt reads far beyond where the next one
+// starts, the following attempts remember their states and stop where they meet the path of an earlier one,
+// so a long run that keeps failing, e.g. of a*b over a's, is read about as many times as the DFA has states.
+// The worst case is still quadratic in the length of such a run: attempts only remember the few thousand positions
+// after their start, and only one of their states of 64 or above per position.
+// The DFA is compiled if needed. Returns the number of matches passed to the callback.
+size_t scan_DFA(struct DFA*, const char *input, size_t length, DFA_Match_Mode mode, DFA_Match_Callback callback, void *context);
+
+// Same as scan_DFA, but the matches are written to the array, starting the scan at *position.
+// The scan stops once the array is full; *position then holds the position to continue the scan from
+// (length if the whole input was scanned). Returns the number of matches written.
+// What the attempts remember is not kept between calls, so small arrays make long failing runs slower than scan_DFA.
+size_t scan_DFA_into(
+    struct DFA*, const char *input, size_t length, DFA_Match_Mode mode,
+    size_t *position, DFA_Match *matches, size_t capacity
+);
+
+#endif
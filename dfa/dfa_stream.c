@@ -0,0 +1,46 @@
+#include <stdlib.h>
+#include "dfa_stream.h"
+#include "compiled_dfa.h"
+
+typedef struct DFA_Stream {
+    const struct Compiled_DFA *compiled;
+    unsigned state;
+    size_t position;
+} DFA_Stream;
+
+DFA_Stream *make_DFA_stream(struct DFA *dfa) {
+    DFA_Stream *stream = (DFA_Stream*) malloc(sizeof(DFA_Stream));
+    stream->compiled = get_compiled_DFA(dfa);
+    reset_DFA_stream(stream);
+    return stream;
+}
+
+void delete_DFA_stream(DFA_Stream *stream) {
+    free(stream);
+}
+
+void reset_DFA_stream(DFA_Stream *stream) {
+    stream->state = 0;
+    stream->position = 0;
+}
+
+int feed_DFA_stream(DFA_Stream *stream, const char *chunk, size_t length) {
+    // Once dead, the stream stays dead, so the chunk does not need to be read
+    if (!is_DFA_stream_dead(stream)) {
+        stream->state = advance_compiled_DFA(stream->compiled, stream->state, chunk, length);
+    }
+    stream->position += length;
+    return is_DFA_stream_dead(stream);
+}
+
+int is_DFA_stream_dead(const DFA_Stream *stream) {
+    return is_compiled_state_dead(stream->compiled, stream->state);
+}
+
+size_t get_DFA_stream_position(const DFA_Stream *stream) {
+    return stream->position;
+}
+
+int finish_DFA_stream(const DFA_Stream *stream) {
+    return is_compiled_state_final(stream->compiled, stream->state);
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include <stddef.h>
+#include "dfa.h"
+
+struct DFA_Stream;
+
+// Instantiates a stream that matches input fed to it in chunks, keeping the current state between the chunks.
+// The DFA is compiled if needed and must not be modified or deleted while the stream is in use.
+struct DFA_Stream *make_DFA_stream(struct DFA*);
+
+// Deletes the stream. The DFA is not affected.
+void delete_DFA_stream(struct DFA_Stream*);
+
+// Starts matching a new input from state 0
+void reset_DFA_stream(struct DFA_Stream*);
+
+// Feeds the next chunk of the input.
+// Returns 1 if the stream has reached a dead state (see is_DFA_stream_dead), otherwise 0.
+int feed_DFA_stream(struct DFA_Stream*, const char *chunk, size_t length);
+
+// Returns 1 if the input fed so far leads to a state from which no final state can be reached.
+// In that case the input is REJECTED whatever is fed next, so feeding can be stopped.
+int is_DFA_stream_dead(const struct DFA_Stream*);
+
+// Returns the number of bytes fed since the stream was made or reset
+size_t get_DFA_stream_position(const struct DFA_Stream*);
+
+// Returns 1 if the input fed so far is ACCEPTED, 0 if it is REJECTED
+int finish_DFA_stream(const struct DFA_Stream*);
\ No newline at end of file
@@ -90,4 +90,22 @@ char *dfa_reader_conflicting_transitions_error(
         t1_destination_state, t2_destination_state
     );
     return error;
-}
\ No newline at end of file
+}
+
+char *regex_syntax_error(size_t position, const char *reason) {
+    int size = 100 + strlen(reason);
+    char *error = malloc(size);
+    snprintf(error, size, "error while compiling regex at position %zu: %s", position, reason);
+    return error;
+}
+
+char *regex_too_many_states_error(unsigned limit) {
+    int size = 200;
+    char *error = malloc(size);
+    snprintf(
+        error, size,
+        "error while compiling regex: the DFA would have more than %u states. "
+        "Consider using a lazy DFA instead.", limit
+    );
+    return error;
+}
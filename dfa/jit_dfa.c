@@ -0,0 +1,309 @@
+#include <stdlib.h>
+#include <string.h>
+#include "compiled_dfa.h"
+
+#if defined(__x86_64__) && defined(__unix__)
+#define DFA_X86_64_JIT 1
+#include <sys/mman.h>
+#endif
+
+// Tables with more entries than this are left to the interpreter
+#define MAX_JIT_TABLE_ENTRIES (1u << 24)
+
+// The generated code is a loop specialized to the DFA. Its table holds, instead of state IDs, the offsets of the rows
+// of the destination states (state ID times the number of letter classes), so a step is a letter class lookup,
+// an addition and a load. Rows are ordered so that the accelerated states and then the single row standing for
+// all dead states come last, which lets one comparison per letter catch both.
+//
+// unsigned loop(const unsigned char **cursor, const unsigned char *end, unsigned row_offset)
+// runs from the row at the cursor until the end of the input, a dead state, or a self-loop of an accelerated state,
+// leaves the cursor after the last letter read and returns the offset of the row reached.
+typedef unsigned (*Jit_Loop)(const unsigned char **cursor, const unsigned char *end, unsigned row_offset);
+
+typedef struct DFA_Jit {
+    void *code;
+    size_t code_size;
+    Jit_Loop loop;
+
+    const Compiled_DFA *compiled; // for skipping self-loops
+    unsigned number_of_classes;
+    unsigned start_offset;
+    unsigned accelerated_offset; // offset of the first row of an accelerated state
+    unsigned dead_offset;        // offset of the row of the dead states
+    unsigned *state_of_row;
+    unsigned char *is_row_final;
+} DFA_Jit;
+
+// Code being generated, with 32-bit displacements to labels that are patched once all labels are placed
+typedef struct Code_Buffer {
+    unsigned char *bytes;
+    size_t size, capacity;
+
+    size_t labels[6];
+    size_t fixups[16];
+    unsigned fixup_labels[16];
+    unsigned number_of_fixups;
+} Code_Buffer;
+
+typedef enum Code_Label {
+    LOOP_LABEL,
+    EXIT_LABEL,
+    SPECIAL_LABEL,
+    CLASSES_LABEL,
+    TABLE_LABEL
+} Code_Label;
+
+// Helper functions declarations
+
+void emit_bytes(Code_Buffer *buffer, const unsigned char *bytes, size_t count);
+void emit_int32(Code_Buffer *buffer, unsigned value);
+
+// Emits a 32-bit displacement to the label, relative to the end of the displacement
+void emit_label_displacement(Code_Buffer *buffer, Code_Label label);
+
+// Orders the rows and fills in the row offsets, the final rows and the table entries.
+// Returns the width in bytes of the table entries.
+unsigned lay_out_rows(const Compiled_DFA *compiled, DFA_Jit *jit, unsigned *row_of_state, unsigned *number_of_rows);
+
+void generate_loop(const Compiled_DFA *compiled, const DFA_Jit *jit, const unsigned *row_of_state, unsigned number_of_rows, unsigned width, Code_Buffer *buffer);
+
+// Gives the structure and its arrays back to the allocator of the compiled DFA
+void release_DFA_jit_arrays(DFA_Jit *jit);
+
+// Definitions of functions from "compiled_dfa.h"
+
+DFA_Jit *make_DFA_jit(const Compiled_DFA *compiled) {
+#ifdef DFA_X86_64_JIT
+    if ((size_t) compiled->number_of_states * compiled->number_of_classes > MAX_JIT_TABLE_ENTRIES) {
+        return NULL;
+    }
+
+    // Everything but the code mapping comes from the allocator of the compiled DFA
+    const DFA_Allocator *allocator = &compiled->allocator;
+    DFA_Jit *jit = (DFA_Jit*) allocate_DFA_memory(allocator, sizeof(DFA_Jit), _Alignof(DFA_Jit));
+    jit->compiled = compiled;
+    jit->number_of_classes = compiled->number_of_classes;
+    jit->state_of_row = (unsigned*) allocate_DFA_memory(allocator, compiled->number_of_states * sizeof(unsigned), _Alignof(unsigned));
+    jit->is_row_final = (unsigned char*) allocate_DFA_memory(allocator, compiled->number_of_states, 1);
+    unsigned *row_of_state = (unsigned*) malloc(compiled->number_of_states * sizeof(unsigned));
+    unsigned number_of_rows;
+    unsigned width = lay_out_rows(compiled, jit, row_of_state, &number_of_rows);
+
+    // Row offsets of 4 bytes in place of narrower state IDs make the table of a large automaton miss the cache
+    // often enough for the loop to be slower than the interpreter
+    if (width == 4 && compiled->state_id_width < 4) {
+        free(row_of_state);
+        release_DFA_jit_arrays(jit);
+        return NULL;
+    }
+
+    Code_Buffer buffer = {0};
+    generate_loop(compiled, jit, row_of_state, number_of_rows, width, &buffer);
+    free(row_of_state);
+
+    // The code is written while the mapping is writable and only then made executable
+    jit->code = mmap(NULL, buffer.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    int is_mapped = jit->code != MAP_FAILED;
+    if (is_mapped) {
+        memcpy(jit->code, buffer.bytes, buffer.size);
+        is_mapped = mprotect(jit->code, buffer.size, PROT_READ | PROT_EXEC) == 0;
+        if (!is_mapped) {
+            munmap(jit->code, buffer.size);
+        }
+    }
+    free(buffer.bytes);
+    if (!is_mapped) {
+        release_DFA_jit_arrays(jit);
+        return NULL;
+    }
+    jit->code_size = buffer.size;
+    jit->loop = (Jit_Loop) jit->code;
+    return jit;
+#else
+    (void) compiled;
+    return NULL;
+#endif
+}
+
+void delete_DFA_jit(DFA_Jit *jit) {
+#ifdef DFA_X86_64_JIT
+    if (jit != NULL) {
+        munmap(jit->code, jit->code_size);
+        release_DFA_jit_arrays(jit);
+    }
+#else
+    (void) jit;
+#endif
+}
+
+int run_DFA_jit(const DFA_Jit *jit, const char *input, size_t length) {
+    const unsigned char *letters = (const unsigned char*) input;
+    const unsigned char *cursor = letters;
+    const unsigned char *end = letters + length;
+    unsigned row_offset = jit->start_offset;
+    while (cursor != end && row_offset < jit->dead_offset) {
+        row_offset = jit->loop(&cursor, end, row_offset);
+
+        // The loop stopped at a self-loop of an accelerated state, so the letters that keep it there are skipped
+        if (cursor != end && row_offset >= jit->accelerated_offset && row_offset < jit->dead_offset) {
+            const Compiled_DFA *compiled = jit->compiled;
+            unsigned state_id = jit->state_of_row[row_offset / jit->number_of_classes];
+            const Self_Loop_Set *set = &compiled->self_loops[compiled->self_loop_index[state_id]];
+            cursor = letters + compiled->skip_self_loops(set, letters, (size_t) (cursor - letters), length);
+        }
+    }
+    return jit->is_row_final[row_offset / jit->number_of_classes];
+}
+
+size_t get_DFA_jit_code_size(const DFA_Jit *jit) {
+    return jit->code_size;
+}
+
+// Helper functions definitions
+
+void emit_bytes(Code_Buffer *buffer, const unsigned char *bytes, size_t count) {
+    if (buffer->size + count > buffer->capacity) {
+        buffer->capacity = 2 * buffer->capacity > buffer->size + count ? 2 * buffer->capacity : buffer->size + count;
+        buffer->bytes = (unsigned char*) realloc(buffer->bytes, buffer->capacity);
+    }
+    memcpy(buffer->bytes + buffer->size, bytes, count);
+    buffer->size += count;
+}
+
+void emit_int32(Code_Buffer *buffer, unsigned value) {
+    unsigned char bytes[4];
+    for (unsigned i = 0; i < 4; i++) {
+        bytes[i] = (unsigned char) (value >> (8 * i));
+    }
+    emit_bytes(buffer, bytes, 4);
+}
+
+void emit_label_displacement(Code_Buffer *buffer, Code_Label label) {
+    buffer->fixups[buffer->number_of_fixups] = buffer->size;
+    buffer->fixup_labels[buffer->number_of_fixups++] = label;
+    emit_int32(buffer, 0);
+}
+
+void release_DFA_jit_arrays(DFA_Jit *jit) {
+    const DFA_Allocator *allocator = &jit->compiled->allocator;
+    release_DFA_memory(allocator, jit->state_of_row);
+    release_DFA_memory(allocator, jit->is_row_final);
+    release_DFA_memory(allocator, jit);
+}
+
+unsigned lay_out_rows(const Compiled_DFA *compiled, DFA_Jit *jit, unsigned *row_of_state, unsigned *number_of_rows) {
+    // Plain live states first, then accelerated ones, then one row for all dead states
+    unsigned rows = 0;
+    for (int accelerated = 0; accelerated <= 1; accelerated++) {
+        if (accelerated) {
+            jit->accelerated_offset = rows * compiled->number_of_classes;
+        }
+        for (unsigned state = 0; state < compiled->number_of_states; state++) {
+            int is_dead = compiled->state_flags[state] & DFA_STATE_DEAD;
+            int is_accelerated = (compiled->state_flags[state] & DFA_STATE_ACCELERATED) != 0;
+            if (!is_dead && is_accelerated == accelerated) {
+                jit->state_of_row[rows] = state;
+                jit->is_row_final[rows] = (unsigned char) is_compiled_state_final(compiled, state);
+                row_of_state[state] = rows++;
+            }
+        }
+    }
+    jit->dead_offset = rows * compiled->number_of_classes;
+    jit->state_of_row[rows] = compiled->garbage_state;
+    for (unsigned state = 0; state < compiled->number_of_states; state++) {
+        if (compiled->state_flags[state] & DFA_STATE_DEAD) {
+            row_of_state[state] = rows;
+        }
+    }
+    *number_of_rows = rows + 1;
+    jit->start_offset = row_of_state[0] * compiled->number_of_classes;
+
+    unsigned largest_offset = jit->dead_offset;
+    return largest_offset <= 0xFF ? 1 : largest_offset <= 0xFFFF ? 2 : 4;
+}
+
+void generate_loop(const Compiled_DFA *compiled, const DFA_Jit *jit, const unsigned *row_of_state, unsigned number_of_rows, unsigned width, Code_Buffer *buffer) {
+    // mov r11, [rdi]; mov eax, edx; lea r8, [rip + <letter classes>]
+    emit_bytes(buffer, (const unsigned char[]) {0x4C, 0x8B, 0x1F, 0x89, 0xD0, 0x4C, 0x8D, 0x05}, 8);
+    emit_label_displacement(buffer, CLASSES_LABEL);
+    // lea r9, [rip + <table>]
+    emit_bytes(buffer, (const unsigned char[]) {0x4C, 0x8D, 0x0D}, 3);
+    emit_label_displacement(buffer, TABLE_LABEL);
+    // cmp r11, rsi; je <exit>
+    emit_bytes(buffer, (const unsigned char[]) {0x49, 0x39, 0xF3, 0x0F, 0x84}, 5);
+    emit_label_displacement(buffer, EXIT_LABEL);
+
+    // The loop is aligned so that its instructions are fetched together
+    while (buffer->size % 16 != 0) {
+        emit_bytes(buffer, (const unsigned char[]) {0x90}, 1);
+    }
+    buffer->labels[LOOP_LABEL] = buffer->size;
+    // mov r10d, eax; movzx ecx, byte [r11]; inc r11; movzx ecx, byte [r8 + rcx]; add eax, ecx
+    emit_bytes(buffer, (const unsigned char[]) {0x41, 0x89, 0xC2, 0x41, 0x0F, 0xB6, 0x0B, 0x49, 0xFF, 0xC3}, 10);
+    emit_bytes(buffer, (const unsigned char[]) {0x41, 0x0F, 0xB6, 0x0C, 0x08, 0x01, 0xC8}, 7);
+    if (width == 1) {
+        // movzx eax, byte [r9 + rax]
+        emit_bytes(buffer, (const unsigned char[]) {0x41, 0x0F, 0xB6, 0x04, 0x01}, 5);
+    } else if (width == 2) {
+        // movzx eax, word [r9 + rax * 2]
+        emit_bytes(buffer, (const unsigned char[]) {0x41, 0x0F, 0xB7, 0x04, 0x41}, 5);
+    } else {
+        // mov eax, dword [r9 + rax * 4]
+        emit_bytes(buffer, (const unsigned char[]) {0x41, 0x8B, 0x04, 0x81}, 4);
+    }
+    // cmp eax, <accelerated offset>; jae <special>
+    emit_bytes(buffer, (const unsigned char[]) {0x3D}, 1);
+    emit_int32(buffer, jit->accelerated_offset);
+    emit_bytes(buffer, (const unsigned char[]) {0x0F, 0x83}, 2);
+    emit_label_displacement(buffer, SPECIAL_LABEL);
+    // cmp r11, rsi; jne <loop>
+    emit_bytes(buffer, (const unsigned char[]) {0x49, 0x39, 0xF3, 0x0F, 0x85}, 5);
+    emit_label_displacement(buffer, LOOP_LABEL);
+
+    // mov [rdi], r11; ret
+    buffer->labels[EXIT_LABEL] = buffer->size;
+    emit_bytes(buffer, (const unsigned char[]) {0x4C, 0x89, 0x1F, 0xC3}, 4);
+
+    // A dead state, or an accelerated state reached from itself, ends the loop
+    buffer->labels[SPECIAL_LABEL] = buffer->size;
+    // cmp eax, <dead offset>; jae <exit>
+    emit_bytes(buffer, (const unsigned char[]) {0x3D}, 1);
+    emit_int32(buffer, jit->dead_offset);
+    emit_bytes(buffer, (const unsigned char[]) {0x0F, 0x83}, 2);
+    emit_label_displacement(buffer, EXIT_LABEL);
+    // cmp eax, r10d; je <exit>
+    emit_bytes(buffer, (const unsigned char[]) {0x44, 0x39, 0xD0, 0x0F, 0x84}, 5);
+    emit_label_displacement(buffer, EXIT_LABEL);
+    // cmp r11, rsi; jne <loop>; jmp <exit>
+    emit_bytes(buffer, (const unsigned char[]) {0x49, 0x39, 0xF3, 0x0F, 0x85}, 5);
+    emit_label_displacement(buffer, LOOP_LABEL);
+    emit_bytes(buffer, (const unsigned char[]) {0xE9}, 1);
+    emit_label_displacement(buffer, EXIT_LABEL);
+
+    // The data follows the code, with the table on its own cache lines
+    buffer->labels[CLASSES_LABEL] = buffer->size;
+    emit_bytes(buffer, compiled->letter_classes, DFA_ALPHABET_SIZE);
+    while (buffer->size % COMPILED_DFA_ALIGNMENT != 0) {
+        emit_bytes(buffer, (const unsigned char[]) {0xCC}, 1);
+    }
+    buffer->labels[TABLE_LABEL] = buffer->size;
+    for (unsigned row = 0; row < number_of_rows; row++) {
+        for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+            unsigned destination = get_compiled_class_transition(compiled, jit->state_of_row[row], c);
+            unsigned entry = row_of_state[destination] * compiled->number_of_classes;
+            unsigned char bytes[4];
+            for (unsigned i = 0; i < width; i++) {
+                bytes[i] = (unsigned char) (entry >> (8 * i));
+            }
+            emit_bytes(buffer, bytes, width);
+        }
+    }
+
+    for (unsigned f = 0; f < buffer->number_of_fixups; f++) {
+        size_t position = buffer->fixups[f];
+        unsigned displacement = (unsigned) (buffer->labels[buffer->fixup_labels[f]] - (position + 4));
+        for (unsigned i = 0; i < 4; i++) {
+            buffer->bytes[position + i] = (unsigned char) (displacement >> (8 * i));
+        }
+    }
+}
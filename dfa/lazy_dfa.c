@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "lazy_dfa.h"
+#include "regex_nfa.h"
+
+#define DEFAULT_LAZY_DFA_CACHE_SIZE (8u << 20)
+
+typedef struct Lazy_DFA {
+    struct Regex_NFA *nfa;
+    struct Subset_Builder *builder; // the states built so far, one per subset of NFA states
+
+    size_t cache_size;
+    unsigned cache_clears;
+} Lazy_DFA;
+
+Lazy_DFA *make_lazy_DFA_from_regex(const char *pattern, int enabled_error_printing) {
+    char *error_message;
+    struct Regex_NFA *nfa = make_regex_NFA(pattern, &error_message);
+    if (nfa == NULL) {
+        if (enabled_error_printing) {
+            printf("%s\n", error_message);
+        }
+        free(error_message);
+        return NULL;
+    }
+
+    Lazy_DFA *lazy = (Lazy_DFA*) malloc(sizeof(Lazy_DFA));
+    lazy->nfa = nfa;
+    lazy->builder = make_subset_builder(nfa);
+    lazy->cache_size = DEFAULT_LAZY_DFA_CACHE_SIZE;
+    lazy->cache_clears = 0;
+    return lazy;
+}
+
+void delete_lazy_DFA(Lazy_DFA *lazy) {
+    if (lazy != NULL) {
+        delete_subset_builder(lazy->builder);
+        delete_regex_NFA(lazy->nfa);
+        free(lazy);
+    }
+}
+
+int run_lazy_DFA(Lazy_DFA *lazy, const char *input, size_t length) {
+    const unsigned char *letters = (const unsigned char*) input;
+    unsigned state = 0;
+    unsigned number_of_states = get_number_of_subsets(lazy->builder);
+    for (size_t i = 0; i < length; i++) {
+        state = get_subset_transition(lazy->builder, state, letters[i]);
+
+        // The cache can only have grown if a new state was built
+        if (get_number_of_subsets(lazy->builder) != number_of_states) {
+            if (get_subset_builder_size(lazy->builder) > lazy->cache_size) {
+                state = clear_subset_builder(lazy->builder, state);
+                lazy->cache_clears++;
+            }
+            number_of_states = get_number_of_subsets(lazy->builder);
+        }
+
+        // No NFA state is left, so nothing read from here on is ACCEPTED
+        if (is_subset_empty(lazy->builder, state)) {
+            return 0;
+        }
+    }
+    return is_subset_final(lazy->builder, state);
+}
+
+unsigned get_lazy_DFA_number_of_states(const Lazy_DFA *lazy) {
+    return get_number_of_subsets(lazy->builder);
+}
+
+void set_lazy_DFA_cache_size(Lazy_DFA *lazy, size_t cache_size) {
+    lazy->cache_size = cache_size;
+}
+
+unsigned get_lazy_DFA_cache_clears(const Lazy_DFA *lazy) {
+    return lazy->cache_clears;
+}
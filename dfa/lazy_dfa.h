@@ -0,0 +1,26 @@
+#include <stddef.h>
+
+struct Lazy_DFA;
+
+// Instantiates a DFA for the regular expression (see make_DFA_from_regex) whose states are built only
+// when an input reaches them, so expressions with huge DFAs can be run on inputs that visit few of their states.
+// The states built are kept in a cache of bounded size (8 MiB unless set otherwise). Once the cache is full
+// it is cleared and the states are built again as they are reached.
+// Returns NULL if the expression is invalid.
+// Pass a non-zero integer for the second parameter to enable printing of errors (in case of any)
+struct Lazy_DFA *make_lazy_DFA_from_regex(const char *pattern, int enabled_error_printing);
+
+void delete_lazy_DFA(struct Lazy_DFA*);
+
+// Returns 1 if the input is ACCEPTED, 0 if it is REJECTED
+int run_lazy_DFA(struct Lazy_DFA*, const char *input, size_t length);
+
+// Returns the number of states built so far
+unsigned get_lazy_DFA_number_of_states(const struct Lazy_DFA*);
+
+// Sets the most memory in bytes that the states built may take
+void set_lazy_DFA_cache_size(struct Lazy_DFA*, size_t cache_size);
+
+// Returns the number of times the cache was cleared because it was full. If it is cleared often,
+// the DFA is mostly built again and again, and a larger cache will make it run faster.
+unsigned get_lazy_DFA_cache_clears(const struct Lazy_DFA*);
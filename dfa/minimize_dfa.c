@@ -0,0 +1,357 @@
+#include <stdlib.h>
+#include <string.h>
+#include "compiled_dfa.h"
+
+// Refinable partition of states (states of the same block are stored next to each other in "elements").
+// The elements of a block that were marked while processing a splitter are moved to the front of the block.
+typedef struct Partition {
+    unsigned *elements;
+    unsigned *location;     // position of every state in "elements"
+    unsigned *block_of;     // block of every state
+
+    unsigned *first, *end;  // block occupies elements[first..end)
+    unsigned *marked_end;   // marked elements of a block are elements[first..marked_end)
+    unsigned number_of_blocks;
+
+    unsigned *touched_blocks;
+    unsigned touched_count;
+} Partition;
+
+typedef struct Labeled_State {
+    unsigned label, state;
+} Labeled_State;
+
+// Helper functions declarations
+
+int compare_labeled_states(const void *a, const void *b);
+
+Partition make_partition(unsigned number_of_states, const unsigned *labels);
+void delete_partition(Partition partition);
+void mark_state(Partition *partition, unsigned state);
+
+// Splits every touched block into its marked and unmarked part. The new blocks are added to the worklist.
+void split_touched_blocks(Partition *partition, unsigned number_of_classes, unsigned *worklist, unsigned *worklist_size, unsigned char *in_worklist);
+
+void add_to_worklist(unsigned block, unsigned letter_class, unsigned number_of_classes, unsigned *worklist, unsigned *worklist_size, unsigned char *in_worklist);
+
+// Returns the label of the state: the given label, or the finality of the state if no labels are given
+unsigned label_of_state(const Compiled_DFA *compiled, const unsigned *labels, unsigned state);
+
+// Definitions of functions from "compiled_dfa.h"
+
+// Hopcroft's partition refinement on the states reachable from state 0.
+// Inverse transitions are indexed per letter class, so one splitter costs as much as the number of its predecessors,
+// and the "smaller half" rule bounds the total work by O(n * k * log n).
+Compiled_DFA *minimize_compiled_DFA(const Compiled_DFA *compiled, const unsigned *labels, unsigned **new_labels) {
+    unsigned number_of_classes = compiled->number_of_classes;
+
+    // Collect the reachable states (breadth first) and give them compact IDs
+    unsigned *compact_id = (unsigned*) malloc(compiled->number_of_states * sizeof(unsigned));
+    unsigned *original_id = (unsigned*) malloc(compiled->number_of_states * sizeof(unsigned));
+    for (unsigned s = 0; s < compiled->number_of_states; s++) {
+        compact_id[s] = compiled->number_of_states;
+    }
+    unsigned m = 0;
+    compact_id[0] = m;
+    original_id[m++] = 0;
+    for (unsigned head = 0; head < m; head++) {
+        for (unsigned c = 0; c < number_of_classes; c++) {
+            unsigned destination = get_compiled_class_transition(compiled, original_id[head], c);
+            if (compact_id[destination] == compiled->number_of_states) {
+                compact_id[destination] = m;
+                original_id[m++] = destination;
+            }
+        }
+    }
+
+    // Inverse transitions: predecessors[inverse_start[c * m + q] .. inverse_start[c * m + q + 1]) lead to q with class c
+    size_t inverse_cells = (size_t) m * number_of_classes;
+    unsigned *inverse_start = (unsigned*) calloc(inverse_cells + 1, sizeof(unsigned));
+    unsigned *predecessors = (unsigned*) malloc((inverse_cells + 1) * sizeof(unsigned));
+    for (unsigned p = 0; p < m; p++) {
+        for (unsigned c = 0; c < number_of_classes; c++) {
+            unsigned q = compact_id[get_compiled_class_transition(compiled, original_id[p], c)];
+            inverse_start[(size_t) c * m + q + 1]++;
+        }
+    }
+    for (size_t i = 0; i < inverse_cells; i++) {
+        inverse_start[i + 1] += inverse_start[i];
+    }
+    unsigned *inverse_fill = (unsigned*) malloc((inverse_cells + 1) * sizeof(unsigned));
+    memcpy(inverse_fill, inverse_start, (inverse_cells + 1) * sizeof(unsigned));
+    for (unsigned p = 0; p < m; p++) {
+        for (unsigned c = 0; c < number_of_classes; c++) {
+            unsigned q = compact_id[get_compiled_class_transition(compiled, original_id[p], c)];
+            predecessors[inverse_fill[(size_t) c * m + q]++] = p;
+        }
+    }
+    free(inverse_fill);
+
+    // Initial partition by labels
+    unsigned *compact_labels = (unsigned*) malloc(m * sizeof(unsigned));
+    for (unsigned p = 0; p < m; p++) {
+        compact_labels[p] = label_of_state(compiled, labels, original_id[p]);
+    }
+    Partition partition = make_partition(m, compact_labels);
+
+    // Every (block, letter class) pair can be in the worklist at most once
+    unsigned *worklist = (unsigned*) malloc(inverse_cells * sizeof(unsigned));
+    unsigned char *in_worklist = (unsigned char*) calloc(inverse_cells, sizeof(unsigned char));
+    unsigned worklist_size = 0;
+    unsigned *splitter_states = (unsigned*) malloc((m + 1) * sizeof(unsigned));
+
+    // All initial blocks but the largest one are splitters
+    unsigned largest_block = 0;
+    for (unsigned b = 1; b < partition.number_of_blocks; b++) {
+        if (partition.end[b] - partition.first[b] > partition.end[largest_block] - partition.first[largest_block]) {
+            largest_block = b;
+        }
+    }
+    for (unsigned b = 0; b < partition.number_of_blocks; b++) {
+        for (unsigned c = 0; c < number_of_classes && b != largest_block; c++) {
+            add_to_worklist(b, c, number_of_classes, worklist, &worklist_size, in_worklist);
+        }
+    }
+
+    while (worklist_size > 0) {
+        unsigned splitter = worklist[--worklist_size];
+        unsigned block = splitter / number_of_classes, c = splitter % number_of_classes;
+        in_worklist[splitter] = 0;
+
+        // Marking reorders elements inside blocks, so the splitter block is copied first
+        unsigned splitter_size = partition.end[block] - partition.first[block];
+        memcpy(splitter_states, &partition.elements[partition.first[block]], splitter_size * sizeof(unsigned));
+
+        // Mark all the states that lead into the splitter block with the letter class
+        for (unsigned i = 0; i < splitter_size; i++) {
+            size_t cell = (size_t) c * m + splitter_states[i];
+            for (unsigned k = inverse_start[cell]; k < inverse_start[cell + 1]; k++) {
+                mark_state(&partition, predecessors[k]);
+            }
+        }
+        split_touched_blocks(&partition, number_of_classes, worklist, &worklist_size, in_worklist);
+    }
+
+    free(worklist);
+    free(in_worklist);
+    free(splitter_states);
+    free(inverse_start);
+    free(predecessors);
+
+    // A block is dead if it is not final and never leaves itself. Such a block becomes the new garbage state.
+    unsigned dead_block = partition.number_of_blocks;
+    for (unsigned b = 0; b < partition.number_of_blocks && dead_block == partition.number_of_blocks; b++) {
+        unsigned representative = original_id[partition.elements[partition.first[b]]];
+        if (label_of_state(compiled, labels, representative) != 0) {
+            continue;
+        }
+        int is_dead = 1;
+        for (unsigned c = 0; c < number_of_classes && is_dead; c++) {
+            unsigned destination = compact_id[get_compiled_class_transition(compiled, representative, c)];
+            is_dead = partition.block_of[destination] == b;
+        }
+        if (is_dead) {
+            dead_block = b;
+        }
+    }
+
+    // Number the live blocks breadth first from the start block; the dead block gets the garbage state ID
+    unsigned *new_id = (unsigned*) malloc(partition.number_of_blocks * sizeof(unsigned));
+    unsigned *block_order = (unsigned*) malloc(partition.number_of_blocks * sizeof(unsigned));
+    for (unsigned b = 0; b < partition.number_of_blocks; b++) {
+        new_id[b] = partition.number_of_blocks;
+    }
+    unsigned live_blocks = 0;
+    if (partition.block_of[0] != dead_block) {
+        new_id[partition.block_of[0]] = live_blocks;
+        block_order[live_blocks++] = partition.block_of[0];
+    }
+    for (unsigned head = 0; head < live_blocks; head++) {
+        unsigned representative = original_id[partition.elements[partition.first[block_order[head]]]];
+        for (unsigned c = 0; c < number_of_classes; c++) {
+            unsigned destination = partition.block_of[compact_id[get_compiled_class_transition(compiled, representative, c)]];
+            if (destination != dead_block && new_id[destination] == partition.number_of_blocks) {
+                new_id[destination] = live_blocks;
+                block_order[live_blocks++] = destination;
+            }
+        }
+    }
+    if (dead_block != partition.number_of_blocks) {
+        new_id[dead_block] = live_blocks;
+    }
+
+    // Build the minimized DFA from one representative per live block
+    unsigned edge_count = 0;
+    DFA_Edge *edges = (DFA_Edge*) malloc(((size_t) live_blocks * DFA_ALPHABET_SIZE + 1) * sizeof(DFA_Edge));
+    unsigned final_states_count = 0;
+    unsigned *final_states = (unsigned*) malloc((live_blocks + 1) * sizeof(unsigned));
+    for (unsigned i = 0; i < live_blocks; i++) {
+        unsigned representative = original_id[partition.elements[partition.first[block_order[i]]]];
+        if (is_compiled_state_final(compiled, representative)) {
+            final_states[final_states_count++] = i;
+        }
+        for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+            unsigned destination = new_id[partition.block_of[compact_id[get_compiled_transition(compiled, representative, letter)]]];
+            if (destination != live_blocks) {
+                edges[edge_count].origin = i;
+                edges[edge_count].destination = destination;
+                edges[edge_count].letter = (unsigned char) letter;
+                edge_count++;
+            }
+        }
+    }
+    Compiled_DFA *minimized = build_compiled_DFA_with_allocator(
+        live_blocks, edges, edge_count, final_states, final_states_count, &compiled->allocator
+    );
+
+    if (new_labels != NULL) {
+        *new_labels = (unsigned*) calloc(live_blocks + 1, sizeof(unsigned));
+        for (unsigned i = 0; i < live_blocks; i++) {
+            unsigned representative = original_id[partition.elements[partition.first[block_order[i]]]];
+            (*new_labels)[i] = label_of_state(compiled, labels, representative);
+        }
+    }
+
+    free(edges);
+    free(final_states);
+    free(new_id);
+    free(block_order);
+    free(compact_labels);
+    free(compact_id);
+    free(original_id);
+    delete_partition(partition);
+    return minimized;
+}
+
+// Definitions of functions from "dfa.h"
+
+struct DFA *minimize_DFA(struct DFA *dfa) {
+    build_DFA_table(dfa);
+    return make_DFA_from_compiled(minimize_compiled_DFA(get_compiled_DFA(dfa), NULL, NULL));
+}
+
+// Helper functions definitions
+
+unsigned label_of_state(const Compiled_DFA *compiled, const unsigned *labels, unsigned state) {
+    return labels != NULL ? labels[state] : (unsigned) is_compiled_state_final(compiled, state);
+}
+
+Partition make_partition(unsigned number_of_states, const unsigned *labels) {
+    Partition partition;
+    partition.elements = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    partition.location = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    partition.block_of = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    partition.first = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    partition.end = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    partition.marked_end = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    partition.touched_blocks = (unsigned*) malloc(number_of_states * sizeof(unsigned));
+    partition.touched_count = 0;
+
+    // Sort the states by label so that every label forms one block
+    Labeled_State *order = (Labeled_State*) malloc((number_of_states + 1) * sizeof(Labeled_State));
+    for (unsigned s = 0; s < number_of_states; s++) {
+        order[s].label = labels[s];
+        order[s].state = s;
+    }
+    qsort(order, number_of_states, sizeof(Labeled_State), compare_labeled_states);
+
+    partition.number_of_blocks = 0;
+    for (unsigned i = 0; i < number_of_states; i++) {
+        unsigned state = order[i].state;
+        if (i == 0 || order[i - 1].label != order[i].label) {
+            unsigned block = partition.number_of_blocks++;
+            partition.first[block] = i;
+            partition.marked_end[block] = i;
+        }
+        partition.end[partition.number_of_blocks - 1] = i + 1;
+        partition.elements[i] = state;
+        partition.location[state] = i;
+        partition.block_of[state] = partition.number_of_blocks - 1;
+    }
+
+    free(order);
+    return partition;
+}
+
+int compare_labeled_states(const void *a, const void *b) {
+    const Labeled_State *x = (const Labeled_State*) a, *y = (const Labeled_State*) b;
+    if (x->label != y->label) {
+        return x->label < y->label ? -1 : 1;
+    }
+    return x->state < y->state ? -1 : (x->state > y->state ? 1 : 0);
+}
+
+void delete_partition(Partition partition) {
+    free(partition.elements);
+    free(partition.location);
+    free(partition.block_of);
+    free(partition.first);
+    free(partition.end);
+    free(partition.marked_end);
+    free(partition.touched_blocks);
+}
+
+void mark_state(Partition *partition, unsigned state) {
+    unsigned block = partition->block_of[state];
+    unsigned position = partition->location[state];
+    unsigned boundary = partition->marked_end[block];
+
+    // Already marked
+    if (position < boundary) {
+        return;
+    }
+
+    // Swap the state with the first unmarked element of its block
+    unsigned other = partition->elements[boundary];
+    partition->elements[boundary] = state;
+    partition->location[state] = boundary;
+    partition->elements[position] = other;
+    partition->location[other] = position;
+
+    if (partition->marked_end[block]++ == partition->first[block]) {
+        partition->touched_blocks[partition->touched_count++] = block;
+    }
+}
+
+void split_touched_blocks(Partition *partition, unsigned number_of_classes, unsigned *worklist, unsigned *worklist_size, unsigned char *in_worklist) {
+    for (unsigned t = 0; t < partition->touched_count; t++) {
+        unsigned block = partition->touched_blocks[t];
+
+        // Whole block was marked: nothing to split
+        if (partition->marked_end[block] == partition->end[block]) {
+            partition->marked_end[block] = partition->first[block];
+            continue;
+        }
+
+        // The marked part becomes a new block
+        unsigned new_block = partition->number_of_blocks++;
+        partition->first[new_block] = partition->first[block];
+        partition->end[new_block] = partition->marked_end[block];
+        partition->marked_end[new_block] = partition->first[new_block];
+        partition->first[block] = partition->end[new_block];
+        partition->marked_end[block] = partition->first[block];
+        for (unsigned i = partition->first[new_block]; i < partition->end[new_block]; i++) {
+            partition->block_of[partition->elements[i]] = new_block;
+        }
+
+        // If the old block is a pending splitter, both halves have to be; otherwise the smaller half is enough
+        unsigned new_size = partition->end[new_block] - partition->first[new_block];
+        unsigned old_size = partition->end[block] - partition->first[block];
+        for (unsigned c = 0; c < number_of_classes; c++) {
+            if (in_worklist[(size_t) block * number_of_classes + c] || new_size <= old_size) {
+                add_to_worklist(new_block, c, number_of_classes, worklist, worklist_size, in_worklist);
+            } else {
+                add_to_worklist(block, c, number_of_classes, worklist, worklist_size, in_worklist);
+            }
+        }
+    }
+    partition->touched_count = 0;
+}
+
+void add_to_worklist(unsigned block, unsigned letter_class, unsigned number_of_classes, unsigned *worklist, unsigned *worklist_size, unsigned char *in_worklist) {
+    size_t splitter = (size_t) block * number_of_classes + letter_class;
+    if (!in_worklist[splitter]) {
+        in_worklist[splitter] = 1;
+        worklist[(*worklist_size)++] = (unsigned) splitter;
+    }
+}
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "compiled_dfa.h"
+
+// Inputs shorter than this are run sequentially
+#define MIN_PARALLEL_CHUNK_LENGTH (1u << 20)
+
+// Automata with more states than this are run sequentially, since every chunk could be read once per state
+#define MAX_ENUMERATED_STATES 1024
+
+// Paths are compared and merged after every block of this many letters
+#define CONVERGENCE_BLOCK_LENGTH 4096
+
+typedef struct Chunk_Job {
+    const Compiled_DFA *compiled;
+    const char *input;
+    size_t length;
+
+    // For the first chunk only state 0 is a possible start state
+    int is_first;
+
+    // End state of the chunk for every start state
+    unsigned *end_state_of;
+} Chunk_Job;
+
+// Helper functions declarations
+
+// Computes the end state of the chunk for every possible start state
+void *run_chunk(void *job);
+
+// Definitions of functions from "dfa.h"
+
+int run_DFA_parallel(struct DFA *dfa, const char *input, size_t length, unsigned threads) {
+    const Compiled_DFA *compiled = get_compiled_DFA(dfa);
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (unsigned) online : 1;
+    }
+    if (threads > length / MIN_PARALLEL_CHUNK_LENGTH) {
+        threads = (unsigned) (length / MIN_PARALLEL_CHUNK_LENGTH);
+    }
+
+    if (threads <= 1 || compiled->number_of_states > MAX_ENUMERATED_STATES) {
+        return is_compiled_state_final(compiled, advance_compiled_DFA(compiled, 0, input, length));
+    }
+
+    Chunk_Job *jobs = (Chunk_Job*) malloc(threads * sizeof(Chunk_Job));
+    pthread_t *workers = (pthread_t*) malloc(threads * sizeof(pthread_t));
+    int *started = (int*) calloc(threads, sizeof(int));
+    size_t chunk_length = length / threads;
+
+    for (unsigned t = 0; t < threads; t++) {
+        jobs[t].compiled = compiled;
+        jobs[t].input = input + t * chunk_length;
+        jobs[t].length = t + 1 == threads ? length - t * chunk_length : chunk_length;
+        jobs[t].is_first = t == 0;
+        jobs[t].end_state_of = (unsigned*) malloc(compiled->number_of_states * sizeof(unsigned));
+    }
+
+    // The calling thread takes the first chunk. If a thread cannot be started, its chunk is run here as well.
+    for (unsigned t = 1; t < threads; t++) {
+        started[t] = pthread_create(&workers[t], NULL, run_chunk, &jobs[t]) == 0;
+    }
+    run_chunk(&jobs[0]);
+    for (unsigned t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(workers[t], NULL);
+        } else {
+            run_chunk(&jobs[t]);
+        }
+    }
+
+    // Chain the per-chunk mappings. A dead state can never lead to acceptance, so the chain stops there.
+    unsigned state = jobs[0].end_state_of[0];
+    for (unsigned t = 1; t < threads && !is_compiled_state_dead(compiled, state); t++) {
+        state = jobs[t].end_state_of[state];
+    }
+    int accepted = is_compiled_state_final(compiled, state);
+
+    for (unsigned t = 0; t < threads; t++) {
+        free(jobs[t].end_state_of);
+    }
+    free(jobs);
+    free(workers);
+    free(started);
+    return accepted;
+}
+
+// Helper functions definitions
+
+void *run_chunk(void *job_ptr) {
+    Chunk_Job *job = (Chunk_Job*) job_ptr;
+    const Compiled_DFA *compiled = job->compiled;
+    unsigned n = compiled->number_of_states;
+
+    // Every live start state begins its own path. Paths that reach the same state are merged,
+    // which in practice leaves very few paths after the first blocks.
+    unsigned *path_of = (unsigned*) malloc(n * sizeof(unsigned));
+    unsigned *path_state = (unsigned*) malloc(n * sizeof(unsigned));
+    unsigned *merged_into = (unsigned*) malloc(n * sizeof(unsigned));
+    unsigned *owner = (unsigned*) malloc(n * sizeof(unsigned));
+    unsigned path_count = 0;
+
+    for (unsigned s = 0; s < n; s++) {
+        owner[s] = n;
+        if (is_compiled_state_dead(compiled, s) || (job->is_first && s != 0)) {
+            // Dead start states stay dead whatever the chunk holds
+            path_of[s] = n;
+            job->end_state_of[s] = s;
+        } else {
+            path_of[s] = path_count;
+            path_state[path_count++] = s;
+        }
+    }
+
+    for (size_t offset = 0; offset < job->length; offset += CONVERGENCE_BLOCK_LENGTH) {
+        size_t block = job->length - offset < CONVERGENCE_BLOCK_LENGTH ? job->length - offset : CONVERGENCE_BLOCK_LENGTH;
+
+        // A path that reached a dead state is not advanced any further: its end state stays dead
+        for (unsigned p = 0; p < path_count; p++) {
+            if (!is_compiled_state_dead(compiled, path_state[p])) {
+                path_state[p] = advance_compiled_DFA(compiled, path_state[p], job->input + offset, block);
+            }
+        }
+
+        // Merge the paths that are in the same state
+        unsigned merged_count = 0;
+        for (unsigned p = 0; p < path_count; p++) {
+            unsigned state = path_state[p];
+            if (owner[state] == n) {
+                owner[state] = merged_count;
+                path_state[merged_count++] = state;
+            }
+            merged_into[p] = owner[state];
+        }
+        for (unsigned p = 0; p < merged_count; p++) {
+            owner[path_state[p]] = n;
+        }
+        for (unsigned s = 0; s < n; s++) {
+            if (path_of[s] != n) {
+                path_of[s] = merged_into[path_of[s]];
+            }
+        }
+        path_count = merged_count;
+    }
+
+    for (unsigned s = 0; s < n; s++) {
+        if (path_of[s] != n) {
+            job->end_state_of[s] = path_state[path_of[s]];
+        }
+    }
+
+    free(path_of);
+    free(path_state);
+    free(merged_into);
+    free(owner);
+    return NULL;
+}
@@ -0,0 +1,389 @@
+#include <stdlib.h>
+#include <string.h>
+#include "product_dfa.h"
+#include "compiled_dfa.h"
+
+// Largest number of states (without the garbage state) of a product
+#define MAX_PRODUCT_STATES (1u << 24)
+
+// Stands for the garbage state of the product while its number of states is not known yet
+#define PRODUCT_GARBAGE ((unsigned) -1)
+
+typedef enum Product_Kind {
+    PRODUCT_UNION,
+    PRODUCT_INTERSECTION
+} Product_Kind;
+
+// Product automaton under construction. Every state is a tuple with one state of each source DFA.
+// Tuples are numbered in the order they are found and looked up with an open addressing hash index.
+typedef struct Product {
+    const Compiled_DFA **sources;
+    unsigned count;
+    Product_Kind kind;
+
+    // Letters get the same class only if they share a class in every source
+    unsigned char letter_classes[DFA_ALPHABET_SIZE];
+    unsigned number_of_classes;
+    unsigned *source_classes; // class of the source DFA i for the product class c, at i * number_of_classes + c
+
+    unsigned *tuples; // tuple of the state s at s * count
+    unsigned number_of_states, capacity;
+    unsigned *class_transitions;
+
+    unsigned *index; // state + 1 per slot, 0 for an empty slot
+    unsigned index_capacity;
+} Product;
+
+typedef struct Multi_DFA {
+    struct Compiled_DFA *compiled;
+    unsigned count;
+
+    // States are labeled by the set of DFAs that ACCEPT in them. Equal sets share a label, and label 0 is the empty set.
+    unsigned *labels;
+    unsigned long long *label_sets; // set of the label l at l * words
+    unsigned words;
+} Multi_DFA;
+
+// Helper functions declarations
+
+// Prepares the product of the DFAs with its combined letter classes and no states
+void init_product(Product *product, struct DFA *dfas[], unsigned count, Product_Kind kind);
+void free_product(Product *product);
+
+// Builds every state reachable from the start tuple. Returns 0 if there are too many of them.
+int explore_product(Product *product);
+
+// Returns the state of the tuple, adding it if it is new, or PRODUCT_GARBAGE if there are too many states
+unsigned find_or_add_tuple(Product *product, const unsigned *tuple);
+
+// Returns 1 if no input read from the tuple can be ACCEPTED by the product, otherwise 0
+int is_tuple_dead(const Product *product, const unsigned *tuple);
+
+size_t hash_tuple(const unsigned *tuple, unsigned count);
+
+// Returns the number of sources that ACCEPT in the product state
+unsigned count_accepting_sources(const Product *product, unsigned state);
+
+// Turns the explored product into a compiled DFA whose final states are those with the given number of
+// accepting sources or more, and minimizes it if asked to
+struct DFA *finish_product(Product *product, unsigned required_accepting, int minimize);
+
+// Labels every state of the compiled product with its set of accepting sources
+void label_product_states(Multi_DFA *multi, const Product *product);
+
+// Definitions of functions from "product_dfa.h"
+
+struct DFA *union_DFAs(struct DFA *dfas[], unsigned count, int minimize) {
+    Product product;
+    init_product(&product, dfas, count, PRODUCT_UNION);
+    return finish_product(&product, 1, minimize);
+}
+
+struct DFA *intersect_DFAs(struct DFA *dfas[], unsigned count, int minimize) {
+    Product product;
+    init_product(&product, dfas, count, PRODUCT_INTERSECTION);
+    return finish_product(&product, count, minimize);
+}
+
+Multi_DFA *make_multi_DFA(struct DFA *dfas[], unsigned count, int minimize) {
+    Product product;
+    init_product(&product, dfas, count, PRODUCT_UNION);
+    if (!explore_product(&product)) {
+        free_product(&product);
+        return NULL;
+    }
+
+    Multi_DFA *multi = (Multi_DFA*) malloc(sizeof(Multi_DFA));
+    multi->count = count;
+    multi->words = (count + 63) / 64;
+    label_product_states(multi, &product);
+    free_product(&product);
+
+    if (minimize) {
+        unsigned *new_labels;
+        struct Compiled_DFA *minimized = minimize_compiled_DFA(multi->compiled, multi->labels, &new_labels);
+        delete_compiled_DFA(multi->compiled);
+        free(multi->labels);
+        multi->compiled = minimized;
+        multi->labels = new_labels;
+    }
+    return multi;
+}
+
+void delete_multi_DFA(Multi_DFA *multi) {
+    if (multi != NULL) {
+        delete_compiled_DFA(multi->compiled);
+        free(multi->labels);
+        free(multi->label_sets);
+        free(multi);
+    }
+}
+
+unsigned run_multi_DFA(const Multi_DFA *multi, const char *input, size_t length, int accepted[]) {
+    unsigned state = advance_compiled_DFA(multi->compiled, 0, input, length);
+    const unsigned long long *set = multi->label_sets + (size_t) multi->labels[state] * multi->words;
+    unsigned accepting = 0;
+    for (unsigned i = 0; i < multi->count; i++) {
+        accepted[i] = (set[i / 64] >> (i % 64)) & 1;
+        accepting += accepted[i];
+    }
+    return accepting;
+}
+
+unsigned get_multi_DFA_number_of_states(const Multi_DFA *multi) {
+    return multi->compiled->number_of_states;
+}
+
+// Helper functions definitions
+
+void init_product(Product *product, struct DFA *dfas[], unsigned count, Product_Kind kind) {
+    product->count = count;
+    product->kind = kind;
+    product->sources = (const Compiled_DFA**) malloc((count + 1) * sizeof(Compiled_DFA*));
+    for (unsigned i = 0; i < count; i++) {
+        product->sources[i] = get_compiled_DFA(dfas[i]);
+    }
+
+    // A letter joins the class of an earlier letter that has the same class in every source
+    unsigned char representatives[DFA_ALPHABET_SIZE];
+    product->number_of_classes = 0;
+    for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+        unsigned c = 0;
+        for (; c < product->number_of_classes; c++) {
+            unsigned i = 0;
+            while (i < count && product->sources[i]->letter_classes[letter] == product->sources[i]->letter_classes[representatives[c]]) {
+                i++;
+            }
+            if (i == count) {
+                break;
+            }
+        }
+        if (c == product->number_of_classes) {
+            representatives[product->number_of_classes++] = (unsigned char) letter;
+        }
+        product->letter_classes[letter] = (unsigned char) c;
+    }
+    product->source_classes = (unsigned*) malloc(((size_t) count * product->number_of_classes + 1) * sizeof(unsigned));
+    for (unsigned i = 0; i < count; i++) {
+        for (unsigned c = 0; c < product->number_of_classes; c++) {
+            product->source_classes[i * product->number_of_classes + c] = product->sources[i]->letter_classes[representatives[c]];
+        }
+    }
+
+    product->number_of_states = 0;
+    product->capacity = 16;
+    product->tuples = (unsigned*) malloc(((size_t) product->capacity * count + 1) * sizeof(unsigned));
+    product->class_transitions = (unsigned*) malloc((size_t) product->capacity * product->number_of_classes * sizeof(unsigned));
+    product->index_capacity = 2 * product->capacity;
+    product->index = (unsigned*) calloc(product->index_capacity, sizeof(unsigned));
+}
+
+void free_product(Product *product) {
+    free(product->sources);
+    free(product->source_classes);
+    free(product->tuples);
+    free(product->class_transitions);
+    free(product->index);
+}
+
+int explore_product(Product *product) {
+    unsigned count = product->count;
+    unsigned *tuple = (unsigned*) malloc((count + 1) * sizeof(unsigned));
+
+    // The start tuple is a state even if nothing can be ACCEPTED from it
+    for (unsigned i = 0; i < count; i++) {
+        tuple[i] = is_compiled_state_dead(product->sources[i], 0) ? product->sources[i]->garbage_state : 0;
+    }
+    find_or_add_tuple(product, tuple);
+
+    // States are numbered in the order they are found, so going through them in order visits every new one
+    for (unsigned state = 0; state < product->number_of_states; state++) {
+        for (unsigned c = 0; c < product->number_of_classes; c++) {
+            // Dead states of a source are all the same, so they are replaced by its garbage state
+            for (unsigned i = 0; i < count; i++) {
+                const Compiled_DFA *source = product->sources[i];
+                unsigned destination = get_compiled_class_transition(
+                    source, product->tuples[(size_t) state * count + i], product->source_classes[i * product->number_of_classes + c]
+                );
+                tuple[i] = is_compiled_state_dead(source, destination) ? source->garbage_state : destination;
+            }
+
+            unsigned destination = PRODUCT_GARBAGE;
+            if (!is_tuple_dead(product, tuple)) {
+                destination = find_or_add_tuple(product, tuple);
+                if (destination == PRODUCT_GARBAGE) {
+                    free(tuple);
+                    return 0;
+                }
+            }
+            product->class_transitions[(size_t) state * product->number_of_classes + c] = destination;
+        }
+    }
+    free(tuple);
+
+    size_t cells = (size_t) product->number_of_states * product->number_of_classes;
+    for (size_t i = 0; i < cells; i++) {
+        if (product->class_transitions[i] == PRODUCT_GARBAGE) {
+            product->class_transitions[i] = product->number_of_states;
+        }
+    }
+    return 1;
+}
+
+unsigned find_or_add_tuple(Product *product, const unsigned *tuple) {
+    unsigned count = product->count;
+    size_t mask = product->index_capacity - 1;
+    size_t slot = hash_tuple(tuple, count) & mask;
+    while (product->index[slot] != 0) {
+        unsigned state = product->index[slot] - 1;
+        if (memcmp(product->tuples + (size_t) state * count, tuple, count * sizeof(unsigned)) == 0) {
+            return state;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (product->number_of_states >= MAX_PRODUCT_STATES) {
+        return PRODUCT_GARBAGE;
+    }
+    if (product->number_of_states == product->capacity) {
+        product->capacity *= 2;
+        product->tuples = (unsigned*) realloc(product->tuples, ((size_t) product->capacity * count + 1) * sizeof(unsigned));
+        product->class_transitions = (unsigned*) realloc(
+            product->class_transitions, (size_t) product->capacity * product->number_of_classes * sizeof(unsigned)
+        );
+
+        // The index is kept at most half full
+        free(product->index);
+        product->index_capacity = 2 * product->capacity;
+        product->index = (unsigned*) calloc(product->index_capacity, sizeof(unsigned));
+        mask = product->index_capacity - 1;
+        for (unsigned state = 0; state < product->number_of_states; state++) {
+            size_t s = hash_tuple(product->tuples + (size_t) state * count, count) & mask;
+            while (product->index[s] != 0) {
+                s = (s + 1) & mask;
+            }
+            product->index[s] = state + 1;
+        }
+        slot = hash_tuple(tuple, count) & mask;
+        while (product->index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    unsigned state = product->number_of_states++;
+    memcpy(product->tuples + (size_t) state * count, tuple, count * sizeof(unsigned));
+    product->index[slot] = state + 1;
+    return state;
+}
+
+int is_tuple_dead(const Product *product, const unsigned *tuple) {
+    // A union is dead when every source is, an intersection as soon as one of them is
+    for (unsigned i = 0; i < product->count; i++) {
+        int is_dead = is_compiled_state_dead(product->sources[i], tuple[i]);
+        if (is_dead == (product->kind == PRODUCT_INTERSECTION)) {
+            return is_dead;
+        }
+    }
+    return product->kind == PRODUCT_UNION;
+}
+
+size_t hash_tuple(const unsigned *tuple, unsigned count) {
+    unsigned long long hash = 0;
+    for (unsigned i = 0; i < count; i++) {
+        hash = (hash ^ tuple[i]) * 0x9E3779B97F4A7C15ULL;
+    }
+    return (size_t) (hash >> 32);
+}
+
+unsigned count_accepting_sources(const Product *product, unsigned state) {
+    unsigned accepting = 0;
+    for (unsigned i = 0; i < product->count; i++) {
+        accepting += is_compiled_state_final(product->sources[i], product->tuples[(size_t) state * product->count + i]);
+    }
+    return accepting;
+}
+
+struct DFA *finish_product(Product *product, unsigned required_accepting, int minimize) {
+    if (!explore_product(product)) {
+        free_product(product);
+        return NULL;
+    }
+
+    unsigned *final_states = (unsigned*) malloc((product->number_of_states + 1) * sizeof(unsigned));
+    unsigned final_states_count = 0;
+    for (unsigned state = 0; state < product->number_of_states; state++) {
+        if (count_accepting_sources(product, state) >= required_accepting) {
+            final_states[final_states_count++] = state;
+        }
+    }
+
+    struct Compiled_DFA *compiled = build_compiled_DFA_from_classes(
+        product->number_of_states, product->letter_classes, product->number_of_classes,
+        product->class_transitions, final_states, final_states_count, NULL
+    );
+    free(final_states);
+    free_product(product);
+
+    if (minimize) {
+        struct Compiled_DFA *minimized = minimize_compiled_DFA(compiled, NULL, NULL);
+        delete_compiled_DFA(compiled);
+        compiled = minimized;
+    }
+    return make_DFA_from_compiled(compiled);
+}
+
+void label_product_states(Multi_DFA *multi, const Product *product) {
+    unsigned words = multi->words;
+    unsigned number_of_states = product->number_of_states;
+
+    // Label 0 (the empty set) is the first one, and the sets are deduplicated with an open addressing index
+    multi->labels = (unsigned*) malloc((number_of_states + 1) * sizeof(unsigned));
+    multi->label_sets = (unsigned long long*) calloc(((size_t) number_of_states + 1) * words + 1, sizeof(unsigned long long));
+    unsigned number_of_labels = 1;
+    size_t index_capacity = 4;
+    while (index_capacity < 2 * ((size_t) number_of_states + 1)) {
+        index_capacity *= 2;
+    }
+    unsigned *index = (unsigned*) calloc(index_capacity, sizeof(unsigned));
+    unsigned *final_states = (unsigned*) malloc((number_of_states + 1) * sizeof(unsigned));
+    unsigned final_states_count = 0;
+
+    for (unsigned state = 0; state < number_of_states; state++) {
+        // The set is written into the next free label and kept only if it is new
+        unsigned long long *set = multi->label_sets + (size_t) number_of_labels * words;
+        unsigned long long hash = 0;
+        int is_empty = 1;
+        for (unsigned i = 0; i < product->count; i++) {
+            if (is_compiled_state_final(product->sources[i], product->tuples[(size_t) state * product->count + i])) {
+                set[i / 64] |= 1ULL << (i % 64);
+                hash = (hash ^ i) * 0x9E3779B97F4A7C15ULL;
+                is_empty = 0;
+            }
+        }
+        if (is_empty) {
+            multi->labels[state] = 0;
+            continue;
+        }
+        final_states[final_states_count++] = state;
+
+        size_t slot = (size_t) (hash >> 32) & (index_capacity - 1);
+        while (index[slot] != 0 && memcmp(multi->label_sets + (size_t) index[slot] * words, set, words * sizeof(unsigned long long)) != 0) {
+            slot = (slot + 1) & (index_capacity - 1);
+        }
+        if (index[slot] == 0) {
+            index[slot] = number_of_labels++;
+        } else {
+            memset(set, 0, words * sizeof(unsigned long long));
+        }
+        multi->labels[state] = index[slot];
+    }
+    multi->labels[number_of_states] = 0;
+    free(index);
+
+    // A state is final if some DFA ACCEPTS in it, so states that lead to no accepting DFA are dead
+    multi->compiled = build_compiled_DFA_from_classes(
+        number_of_states, product->letter_classes, product->number_of_classes,
+        product->class_transitions, final_states, final_states_count, NULL
+    );
+    free(final_states);
+}
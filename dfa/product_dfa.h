@@ -0,0 +1,28 @@
+#include <stddef.h>
+#include "dfa.h"
+
+// Builds the DFA that ACCEPTS the words ACCEPTED by any of the given DFAs.
+// Only the combinations of states that some input reaches are built, and combinations in which no DFA
+// can ACCEPT any more collapse into the garbage state. If minimize is non-zero the result is minimized.
+// The DFAs are compiled if needed. Returns NULL if the product would have more than 2^24 states.
+struct DFA *union_DFAs(struct DFA *dfas[], unsigned count, int minimize);
+
+// Builds the DFA that ACCEPTS the words ACCEPTED by all of the given DFAs (see union_DFAs)
+struct DFA *intersect_DFAs(struct DFA *dfas[], unsigned count, int minimize);
+
+// Combined automaton that tells which of several DFAs ACCEPT an input after reading it once.
+// Every state of the product carries the set of DFAs that ACCEPT in it.
+struct Multi_DFA;
+
+// Builds the combined automaton of the given DFAs (see union_DFAs).
+// Minimization only merges states that lead to the same sets of accepting DFAs.
+struct Multi_DFA *make_multi_DFA(struct DFA *dfas[], unsigned count, int minimize);
+
+void delete_multi_DFA(struct Multi_DFA*);
+
+// Reads the input once and sets accepted[i] to 1 if the i-th DFA ACCEPTS it, otherwise 0.
+// Returns the number of DFAs that ACCEPT the input.
+unsigned run_multi_DFA(const struct Multi_DFA*, const char *input, size_t length, int accepted[]);
+
+// Returns the number of states of the combined automaton (including the garbage state)
+unsigned get_multi_DFA_number_of_states(const struct Multi_DFA*);
@@ -1,16 +1,28 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "read_dfa_from_file.h"
 #include "dfa_reader.h"
 
-// Returns 1 if EOF encountered. It dynamically expands the length of the line
-int get_line_from_file(FILE *file, char **line_ptr, int *len);
+// Size of the blocks read from files that cannot be mapped (e.g. pipes)
+#define READ_BLOCK_SIZE (1u << 16)
+
+// Reads the whole file into a buffer in large blocks. Returns NULL if reading fails.
+char *read_whole_file(int fd, size_t *length);
 
 struct DFA *read_dfa_from_file(const char *filename, int enabled_error_printing) {
+    return read_dfa_from_file_with_allocator(filename, enabled_error_printing, NULL);
+}
+
+struct DFA *read_dfa_from_file_with_allocator(const char *filename, int enabled_error_printing, const struct DFA_Allocator *allocator) {
 
     // Handle openning the file
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
         if (enabled_error_printing) {
             printf(
                 "error while opening the file \"%s\": "
@@ -20,25 +32,51 @@ struct DFA *read_dfa_from_file(const char *filename, int enabled_error_printing)
         return NULL;
     }
 
+    // Regular files are mapped, so their lines are handed to the DFA Reader without being copied
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        size_t length = (size_t) file_stat.st_size;
+        void *mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            close(fd);
+            madvise(mapping, length, MADV_SEQUENTIAL);
+            struct DFA *dfa = read_dfa_from_memory_with_allocator((const char*) mapping, length, enabled_error_printing, allocator);
+            munmap(mapping, length);
+            return dfa;
+        }
+    }
+
+    // Otherwise, the file is read in large blocks
+    size_t length = 0;
+    char *content = read_whole_file(fd, &length);
+    close(fd);
+    if (content == NULL) {
+        if (enabled_error_printing) {
+            printf("error while reading the file \"%s\".\n", filename);
+        }
+        return NULL;
+    }
+
+    struct DFA *dfa = read_dfa_from_memory_with_allocator(content, length, enabled_error_printing, allocator);
+    free(content);
+    return dfa;
+}
+
+struct DFA *read_dfa_from_memory(const char *content, size_t length, int enabled_error_printing) {
+    return read_dfa_from_memory_with_allocator(content, length, enabled_error_printing, NULL);
+}
+
+struct DFA *read_dfa_from_memory_with_allocator(
+    const char *content, size_t length, int enabled_error_printing, const struct DFA_Allocator *allocator
+) {
+
     // Instantiate DFA Reader
     struct DFA_Reader *dfa_reader = make_DFA_reader();
+    set_DFA_reader_allocator(dfa_reader, allocator);
 
-    // Instantiate memory for line-by-line fetching
-    int line_length = 30;
-    char *line = (char*) calloc(line_length, sizeof(char));
-    int eof_reached = 0;
+    // Process the lines by the DFA Reader; large descriptions are parsed by several threads
+    read_DFA_lines(dfa_reader, content, length, 0);
 
-    // Keep fetching the line & processing it by the DFA Reader
-    // until EOF is reached or DFA reader error has been encountered 
-    while (!eof_reached && !has_error(dfa_reader)) {
-        eof_reached = get_line_from_file(file, &line, &line_length);
-        read_DFA_line(dfa_reader, line);
-    }
-    
-    // Close the file & free memory used for line-by-line fetching
-    free(line);
-    fclose(file);
-    
     struct DFA *dfa = finish_and_get_DFA(dfa_reader);
 
     if (has_error(dfa_reader) && enabled_error_printing) {
@@ -49,31 +87,26 @@ struct DFA *read_dfa_from_file(const char *filename, int enabled_error_printing)
     return dfa;
 }
 
-int get_line_from_file(FILE *file, char **line_ptr, int *line_length) {
-    char *line = *line_ptr;
-    int done = 0;
-    int i = 0;
-    int is_eof_reached = 0;
-
-    while (!done) {
-        // dynamically increase the line length when needed
-        if (i >= *line_length) {
-            *line_length = *line_length * 2;
-            line = realloc(line, *line_length);
-            *line_ptr = line;
-        }
+char *read_whole_file(int fd, size_t *length) {
+    size_t capacity = READ_BLOCK_SIZE;
+    char *content = (char*) malloc(capacity);
+    *length = 0;
 
-        int c = fgetc(file);
-        is_eof_reached = c == EOF ? 1 : 0;
+    while (1) {
+        // dynamically increase the buffer when needed
+        if (*length == capacity) {
+            capacity *= 2;
+            content = realloc(content, capacity);
+        }
 
-        // If EOF or \n reached, finish reading the current line
-        if (c == EOF || c == '\n') {
-            line[i++] = 0;
-            done = 1;
-        } else {
-            line[i++] = c;
+        ssize_t bytes_read = read(fd, content + *length, capacity - *length);
+        if (bytes_read == 0) {
+            return content;
+        }
+        if (bytes_read < 0) {
+            free(content);
+            return NULL;
         }
+        *length += (size_t) bytes_read;
     }
-
-    return is_eof_reached;
-}
\ No newline at end of file
+}
@@ -2,4 +2,17 @@
 
 // Reads DFA from a file. Returns a pointer to DFA if everything is ok, otherwise NULL pointer.
 // Pass a non-zero integer for the second parameter to enable printing of errors (in case of any) 
-struct DFA *read_dfa_from_file(const char *filename, int enabled_error_printing);
\ No newline at end of file
+struct DFA *read_dfa_from_file(const char *filename, int enabled_error_printing);
+
+// Same as read_dfa_from_file, but the DFA description is read from the given memory (e.g. one embedded in a larger file).
+// The content need not be NUL-terminated; lines are separated by '\n'.
+struct DFA *read_dfa_from_memory(const char *content, size_t length, int enabled_error_printing);
+
+// Same as read_dfa_from_file, but the DFA is allocated from the given allocator (see dfa_allocator.h).
+// Loading many DFAs into one arena lets them be unloaded all at once by deleting the arena.
+struct DFA *read_dfa_from_file_with_allocator(const char *filename, int enabled_error_printing, const struct DFA_Allocator *allocator);
+
+// Same as read_dfa_from_memory, but the DFA is allocated from the given allocator
+struct DFA *read_dfa_from_memory_with_allocator(
+    const char *content, size_t length, int enabled_error_printing, const struct DFA_Allocator *allocator
+);
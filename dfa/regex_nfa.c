@@ -0,0 +1,567 @@
+#include <stdlib.h>
+#include <string.h>
+#include "errors.h"
+#include "regex_nfa.h"
+
+// Largest count allowed in a bounded repetition, e.g. a{1000}
+#define MAX_REPETITION_COUNT 1000
+
+#define UNBOUNDED_REPETITION ((unsigned) -1)
+
+// Deepest nesting of groups (and most repetition operators on one atom) allowed, which bounds the recursion
+#define MAX_GROUP_DEPTH 256
+
+// Largest NFA built; repetitions of repetitions could otherwise ask for more memory than there is
+#define MAX_NFA_STATES (1u << 24)
+
+typedef enum Regex_Node_Type { REGEX_EMPTY, REGEX_LETTERS, REGEX_CONCATENATION, REGEX_ALTERNATION, REGEX_REPETITION } Regex_Node_Type;
+
+// Node of the syntax tree of a regular expression.
+// Concatenations and alternations keep all their operands in one node, so long expressions do not make the tree deep.
+typedef struct Regex_Node {
+    Regex_Node_Type type;
+    unsigned long long letters[4]; // for REGEX_LETTERS
+
+    struct Regex_Node **operands; // a repetition has exactly one
+    unsigned operand_count;
+    unsigned operand_capacity;
+
+    unsigned min, max; // for REGEX_REPETITION
+} Regex_Node;
+
+typedef struct Regex_Parser {
+    const char *pattern;
+    size_t position;
+    unsigned depth; // number of groups open
+    char *error_message;
+} Regex_Parser;
+
+// Part of the NFA with a single entry and a single exit. The exit state has no out edges yet.
+typedef struct NFA_Fragment {
+    unsigned start, end;
+} NFA_Fragment;
+
+// Helper functions declarations
+
+// Recursive descent over the grammar:
+//   alternation   := concatenation ('|' concatenation)*
+//   concatenation := repetition*
+//   repetition    := atom ('*' | '+' | '?' | '{m}' | '{m,}' | '{m,n}')*
+//   atom          := '(' alternation ')' | '[' set ']' | '.' | '\' escape | letter
+// Every function returns NULL once an error is set.
+Regex_Node *parse_alternation(Regex_Parser *parser);
+Regex_Node *parse_concatenation(Regex_Parser *parser);
+Regex_Node *parse_repetition(Regex_Parser *parser);
+Regex_Node *parse_atom(Regex_Parser *parser);
+Regex_Node *parse_letter_set(Regex_Parser *parser);
+
+// Reads a letter or an escape sequence into the set. Returns the letter if it was a single one, otherwise -1.
+int parse_set_member(Regex_Parser *parser, unsigned long long letters[4]);
+
+// Reads the number of a bounded repetition. Returns 0 if there is no number.
+int parse_repetition_count(Regex_Parser *parser, unsigned *count);
+
+Regex_Node *make_regex_node(Regex_Node_Type type);
+void add_regex_operand(Regex_Node *node, Regex_Node *operand);
+void delete_regex_node(Regex_Node *node);
+Regex_Node *regex_parse_error(Regex_Parser *parser, const char *reason);
+
+void add_letter_to_set(unsigned long long letters[4], unsigned char letter);
+void add_letter_range_to_set(unsigned long long letters[4], unsigned char first, unsigned char last);
+
+// Returns the number of NFA states the node is built with, saturating at MAX_NFA_STATES + 1
+unsigned long long count_NFA_states(const Regex_Node *node);
+
+// Thompson construction
+unsigned add_NFA_state(Regex_NFA *nfa);
+void add_NFA_epsilon(Regex_NFA *nfa, unsigned origin, unsigned destination);
+NFA_Fragment build_NFA_fragment(Regex_NFA *nfa, const Regex_Node *node);
+
+// Definitions of functions from "regex_nfa.h"
+
+Regex_NFA *make_regex_NFA(const char *pattern, char **error_message) {
+    Regex_Parser parser = { pattern, 0, 0, NULL };
+    Regex_Node *root = parse_alternation(&parser);
+    if (root != NULL && pattern[parser.position] != '\0') {
+        // Only an unmatched ')' stops the alternation before the end
+        delete_regex_node(root);
+        root = regex_parse_error(&parser, "unmatched ')'");
+    }
+    if (root != NULL && count_NFA_states(root) > MAX_NFA_STATES) {
+        delete_regex_node(root);
+        parser.position = 0;
+        root = regex_parse_error(&parser, "the expression is too large");
+    }
+    if (root == NULL) {
+        *error_message = parser.error_message;
+        return NULL;
+    }
+
+    Regex_NFA *nfa = (Regex_NFA*) malloc(sizeof(Regex_NFA));
+    nfa->number_of_states = 0;
+    nfa->capacity = 64;
+    nfa->states = (NFA_State*) malloc(nfa->capacity * sizeof(NFA_State));
+
+    NFA_Fragment fragment = build_NFA_fragment(nfa, root);
+    nfa->start_state = fragment.start;
+    nfa->accept_state = fragment.end;
+    delete_regex_node(root);
+
+    *error_message = NULL;
+    return nfa;
+}
+
+void delete_regex_NFA(Regex_NFA *nfa) {
+    if (nfa != NULL) {
+        free(nfa->states);
+        free(nfa);
+    }
+}
+
+// Helper functions definitions
+
+Regex_Node *parse_alternation(Regex_Parser *parser) {
+    Regex_Node *node = parse_concatenation(parser);
+    if (node == NULL || parser->pattern[parser->position] != '|') {
+        return node;
+    }
+
+    Regex_Node *alternation = make_regex_node(REGEX_ALTERNATION);
+    add_regex_operand(alternation, node);
+    while (parser->pattern[parser->position] == '|') {
+        parser->position++;
+        node = parse_concatenation(parser);
+        if (node == NULL) {
+            delete_regex_node(alternation);
+            return NULL;
+        }
+        add_regex_operand(alternation, node);
+    }
+    return alternation;
+}
+
+Regex_Node *parse_concatenation(Regex_Parser *parser) {
+    Regex_Node *concatenation = make_regex_node(REGEX_CONCATENATION);
+    char c = parser->pattern[parser->position];
+    while (c != '\0' && c != '|' && c != ')') {
+        Regex_Node *node = parse_repetition(parser);
+        if (node == NULL) {
+            delete_regex_node(concatenation);
+            return NULL;
+        }
+        add_regex_operand(concatenation, node);
+        c = parser->pattern[parser->position];
+    }
+
+    // An empty concatenation matches the empty word, a single operand stands for itself
+    if (concatenation->operand_count <= 1) {
+        Regex_Node *node = concatenation->operand_count == 0 ? make_regex_node(REGEX_EMPTY) : concatenation->operands[0];
+        concatenation->operand_count = 0;
+        delete_regex_node(concatenation);
+        return node;
+    }
+    return concatenation;
+}
+
+Regex_Node *parse_repetition(Regex_Parser *parser) {
+    Regex_Node *node = parse_atom(parser);
+    for (unsigned operators = 0; node != NULL; operators++) {
+        size_t operator_position = parser->position;
+        if (operators == MAX_GROUP_DEPTH) {
+            delete_regex_node(node);
+            return regex_parse_error(parser, "too many repetition operators");
+        }
+        unsigned min, max;
+        switch (parser->pattern[parser->position]) {
+        case '*':
+            min = 0, max = UNBOUNDED_REPETITION;
+            break;
+        case '+':
+            min = 1, max = UNBOUNDED_REPETITION;
+            break;
+        case '?':
+            min = 0, max = 1;
+            break;
+        case '{':
+            parser->position++;
+            if (!parse_repetition_count(parser, &min)) {
+                delete_regex_node(node);
+                return regex_parse_error(parser, "expected a number after '{'");
+            }
+            max = min;
+            if (parser->pattern[parser->position] == ',') {
+                parser->position++;
+                if (!parse_repetition_count(parser, &max)) {
+                    max = UNBOUNDED_REPETITION;
+                }
+            }
+            if (parser->pattern[parser->position] != '}') {
+                delete_regex_node(node);
+                return regex_parse_error(parser, "expected '}'");
+            }
+            if (min > MAX_REPETITION_COUNT || (max != UNBOUNDED_REPETITION && max > MAX_REPETITION_COUNT)) {
+                delete_regex_node(node);
+                parser->position = operator_position;
+                return regex_parse_error(parser, "repetition count is too large");
+            }
+            if (max < min) {
+                delete_regex_node(node);
+                parser->position = operator_position;
+                return regex_parse_error(parser, "repetition range is reversed");
+            }
+            break;
+        default:
+            return node;
+        }
+        parser->position++;
+
+        Regex_Node *repetition = make_regex_node(REGEX_REPETITION);
+        add_regex_operand(repetition, node);
+        repetition->min = min;
+        repetition->max = max;
+        node = repetition;
+    }
+    return node;
+}
+
+Regex_Node *parse_atom(Regex_Parser *parser) {
+    char c = parser->pattern[parser->position];
+    Regex_Node *node;
+    switch (c) {
+    case '(':
+        if (parser->depth == MAX_GROUP_DEPTH) {
+            return regex_parse_error(parser, "groups are nested too deeply");
+        }
+        parser->position++;
+        parser->depth++;
+        node = parse_alternation(parser);
+        parser->depth--;
+        if (node != NULL && parser->pattern[parser->position] != ')') {
+            delete_regex_node(node);
+            return regex_parse_error(parser, "expected ')'");
+        }
+        if (node != NULL) {
+            parser->position++;
+        }
+        return node;
+    case '[':
+        parser->position++;
+        return parse_letter_set(parser);
+    case '*':
+    case '+':
+    case '?':
+    case '{':
+        return regex_parse_error(parser, "nothing to repeat");
+    case '.':
+        parser->position++;
+        node = make_regex_node(REGEX_LETTERS);
+        add_letter_range_to_set(node->letters, 0, 255);
+        return node;
+    default:
+        node = make_regex_node(REGEX_LETTERS);
+        if (parse_set_member(parser, node->letters) == -2) {
+            delete_regex_node(node);
+            return NULL;
+        }
+        return node;
+    }
+}
+
+Regex_Node *parse_letter_set(Regex_Parser *parser) {
+    Regex_Node *node = make_regex_node(REGEX_LETTERS);
+    int negated = parser->pattern[parser->position] == '^';
+    if (negated) {
+        parser->position++;
+    }
+
+    // A ']' right at the start is a member, not the end of the set
+    int is_first = 1;
+    while (parser->pattern[parser->position] != ']' || is_first) {
+        if (parser->pattern[parser->position] == '\0') {
+            delete_regex_node(node);
+            return regex_parse_error(parser, "expected ']'");
+        }
+        is_first = 0;
+
+        int first = parse_set_member(parser, node->letters);
+        if (first == -2) {
+            delete_regex_node(node);
+            return NULL;
+        }
+
+        // A range such as a-z; a '-' before the closing ']' is a member
+        const char *rest = parser->pattern + parser->position;
+        if (first >= 0 && rest[0] == '-' && rest[1] != ']' && rest[1] != '\0') {
+            parser->position++;
+            unsigned long long last_letters[4] = {0};
+            int last = parse_set_member(parser, last_letters);
+            if (last == -2) {
+                delete_regex_node(node);
+                return NULL;
+            }
+            if (last < 0) {
+                delete_regex_node(node);
+                return regex_parse_error(parser, "a range must end with a single letter");
+            }
+            if (last < first) {
+                delete_regex_node(node);
+                return regex_parse_error(parser, "letter range is reversed");
+            }
+            add_letter_range_to_set(node->letters, (unsigned char) first, (unsigned char) last);
+        }
+    }
+    parser->position++;
+
+    if (negated) {
+        for (unsigned i = 0; i < 4; i++) {
+            node->letters[i] = ~node->letters[i];
+        }
+    }
+    return node;
+}
+
+int parse_set_member(Regex_Parser *parser, unsigned long long letters[4]) {
+    unsigned char c = (unsigned char) parser->pattern[parser->position++];
+    if (c != '\\') {
+        add_letter_to_set(letters, c);
+        return c;
+    }
+
+    c = (unsigned char) parser->pattern[parser->position++];
+    switch (c) {
+    case '\0':
+        parser->position--;
+        regex_parse_error(parser, "pattern ends with '\\'");
+        return -2;
+    case 'n':
+        add_letter_to_set(letters, '\n');
+        return '\n';
+    case 't':
+        add_letter_to_set(letters, '\t');
+        return '\t';
+    case 'r':
+        add_letter_to_set(letters, '\r');
+        return '\r';
+    case 'f':
+        add_letter_to_set(letters, '\f');
+        return '\f';
+    case 'v':
+        add_letter_to_set(letters, '\v');
+        return '\v';
+    case 'x': {
+        unsigned value = 0;
+        for (unsigned i = 0; i < 2; i++) {
+            char h = parser->pattern[parser->position];
+            unsigned digit = '0' <= h && h <= '9' ? h - '0' : 'a' <= h && h <= 'f' ? h - 'a' + 10 : 'A' <= h && h <= 'F' ? h - 'A' + 10 : 16;
+            if (digit == 16) {
+                regex_parse_error(parser, "expected two hexadecimal digits after \\x");
+                return -2;
+            }
+            value = value * 16 + digit;
+            parser->position++;
+        }
+        add_letter_to_set(letters, (unsigned char) value);
+        return (int) value;
+    }
+    case 'd':
+    case 'D':
+    case 'w':
+    case 'W':
+    case 's':
+    case 'S': {
+        unsigned long long set[4] = {0};
+        char kind = c | 0x20;
+        if (kind == 'd' || kind == 'w') {
+            add_letter_range_to_set(set, '0', '9');
+        }
+        if (kind == 'w') {
+            add_letter_range_to_set(set, 'a', 'z');
+            add_letter_range_to_set(set, 'A', 'Z');
+            add_letter_to_set(set, '_');
+        }
+        if (kind == 's') {
+            add_letter_range_to_set(set, '\t', '\r');
+            add_letter_to_set(set, ' ');
+        }
+        for (unsigned i = 0; i < 4; i++) {
+            letters[i] |= c == kind ? set[i] : ~set[i];
+        }
+        return -1;
+    }
+    default:
+        // Any other escaped letter stands for itself, e.g. \. or \*
+        add_letter_to_set(letters, c);
+        return c;
+    }
+}
+
+int parse_repetition_count(Regex_Parser *parser, unsigned *count) {
+    const char *digits = parser->pattern + parser->position;
+    size_t length = 0;
+    unsigned long value = 0;
+    while ('0' <= digits[length] && digits[length] <= '9') {
+        // Anything above the limit is rejected by the caller, so the value only has to stay above it
+        value = value > MAX_REPETITION_COUNT ? value : value * 10 + (digits[length] - '0');
+        length++;
+    }
+    parser->position += length;
+    *count = (unsigned) value;
+    return length > 0 ? 1 : 0;
+}
+
+Regex_Node *make_regex_node(Regex_Node_Type type) {
+    Regex_Node *node = (Regex_Node*) calloc(1, sizeof(Regex_Node));
+    node->type = type;
+    return node;
+}
+
+void add_regex_operand(Regex_Node *node, Regex_Node *operand) {
+    if (node->operand_count == node->operand_capacity) {
+        node->operand_capacity = node->operand_capacity == 0 ? 2 : 2 * node->operand_capacity;
+        node->operands = realloc(node->operands, node->operand_capacity * sizeof(Regex_Node*));
+    }
+    node->operands[node->operand_count++] = operand;
+}
+
+void delete_regex_node(Regex_Node *node) {
+    if (node != NULL) {
+        for (unsigned i = 0; i < node->operand_count; i++) {
+            delete_regex_node(node->operands[i]);
+        }
+        free(node->operands);
+        free(node);
+    }
+}
+
+Regex_Node *regex_parse_error(Regex_Parser *parser, const char *reason) {
+    if (parser->error_message == NULL) {
+        parser->error_message = regex_syntax_error(parser->position, reason);
+    }
+    return NULL;
+}
+
+void add_letter_to_set(unsigned long long letters[4], unsigned char letter) {
+    letters[letter / 64] |= 1ULL << (letter % 64);
+}
+
+void add_letter_range_to_set(unsigned long long letters[4], unsigned char first, unsigned char last) {
+    for (unsigned letter = first; letter <= last; letter++) {
+        add_letter_to_set(letters, (unsigned char) letter);
+    }
+}
+
+unsigned long long count_NFA_states(const Regex_Node *node) {
+    unsigned long long count = 0, limit = MAX_NFA_STATES + 1ULL;
+    switch (node->type) {
+    case REGEX_EMPTY:
+        return 1;
+    case REGEX_LETTERS:
+        return 2;
+    case REGEX_CONCATENATION:
+    case REGEX_ALTERNATION:
+        count = 2ULL * node->operand_count;
+        for (unsigned i = 0; i < node->operand_count && count < limit; i++) {
+            count += count_NFA_states(node->operands[i]);
+        }
+        break;
+    case REGEX_REPETITION: {
+        unsigned long long copies = node->max == UNBOUNDED_REPETITION ? node->min + 1ULL : node->max;
+        count = 2 + copies * count_NFA_states(node->operands[0]);
+        break;
+    }
+    }
+    return count < limit ? count : limit;
+}
+
+unsigned add_NFA_state(Regex_NFA *nfa) {
+    if (nfa->number_of_states == nfa->capacity) {
+        nfa->capacity *= 2;
+        nfa->states = realloc(nfa->states, nfa->capacity * sizeof(NFA_State));
+    }
+    NFA_State *state = &nfa->states[nfa->number_of_states];
+    memset(state->letters, 0, sizeof(state->letters));
+    state->reads_letter = 0;
+    state->out[0] = state->out[1] = NFA_NO_STATE;
+    return nfa->number_of_states++;
+}
+
+void add_NFA_epsilon(Regex_NFA *nfa, unsigned origin, unsigned destination) {
+    NFA_State *state = &nfa->states[origin];
+    state->out[state->out[0] == NFA_NO_STATE ? 0 : 1] = destination;
+}
+
+NFA_Fragment build_NFA_fragment(Regex_NFA *nfa, const Regex_Node *node) {
+    NFA_Fragment fragment, left, right;
+    switch (node->type) {
+    case REGEX_EMPTY:
+        fragment.start = fragment.end = add_NFA_state(nfa);
+        return fragment;
+
+    case REGEX_LETTERS:
+        fragment.start = add_NFA_state(nfa);
+        fragment.end = add_NFA_state(nfa);
+        memcpy(nfa->states[fragment.start].letters, node->letters, sizeof(node->letters));
+        nfa->states[fragment.start].reads_letter = 1;
+        nfa->states[fragment.start].out[0] = fragment.end;
+        return fragment;
+
+    case REGEX_CONCATENATION:
+        fragment = build_NFA_fragment(nfa, node->operands[0]);
+        for (unsigned i = 1; i < node->operand_count; i++) {
+            right = build_NFA_fragment(nfa, node->operands[i]);
+            add_NFA_epsilon(nfa, fragment.end, right.start);
+            fragment.end = right.end;
+        }
+        return fragment;
+
+    case REGEX_ALTERNATION:
+        // A chain of states that branch into one operand each, so every state has at most two out edges
+        fragment.end = add_NFA_state(nfa);
+        fragment.start = add_NFA_state(nfa);
+        for (unsigned i = 0, branch = fragment.start; i < node->operand_count; i++) {
+            left = build_NFA_fragment(nfa, node->operands[i]);
+            add_NFA_epsilon(nfa, branch, left.start);
+            add_NFA_epsilon(nfa, left.end, fragment.end);
+            if (i + 2 < node->operand_count) {
+                unsigned next_branch = add_NFA_state(nfa);
+                add_NFA_epsilon(nfa, branch, next_branch);
+                branch = next_branch;
+            } else if (i + 2 == node->operand_count) {
+                right = build_NFA_fragment(nfa, node->operands[++i]);
+                add_NFA_epsilon(nfa, branch, right.start);
+                add_NFA_epsilon(nfa, right.end, fragment.end);
+            }
+        }
+        return fragment;
+
+    case REGEX_REPETITION:
+    default:
+        // The required copies are chained first, then either a loop or the optional copies
+        fragment.start = fragment.end = add_NFA_state(nfa);
+        for (unsigned i = 0; i < node->min; i++) {
+            left = build_NFA_fragment(nfa, node->operands[0]);
+            add_NFA_epsilon(nfa, fragment.end, left.start);
+            fragment.end = left.end;
+        }
+        if (node->max == UNBOUNDED_REPETITION) {
+            left = build_NFA_fragment(nfa, node->operands[0]);
+            unsigned exit = add_NFA_state(nfa);
+            add_NFA_epsilon(nfa, fragment.end, left.start);
+            add_NFA_epsilon(nfa, fragment.end, exit);
+            add_NFA_epsilon(nfa, left.end, left.start);
+            add_NFA_epsilon(nfa, left.end, exit);
+            fragment.end = exit;
+        } else {
+            unsigned exit = add_NFA_state(nfa);
+            for (unsigned i = node->min; i < node->max; i++) {
+                left = build_NFA_fragment(nfa, node->operands[0]);
+                add_NFA_epsilon(nfa, fragment.end, left.start);
+                add_NFA_epsilon(nfa, fragment.end, exit);
+                fragment.end = left.end;
+            }
+            add_NFA_epsilon(nfa, fragment.end, exit);
+            fragment.end = exit;
+        }
+        return fragment;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef REGEX_NFA_H
+#define REGEX_NFA_H
+
+#include <stddef.h>
+
+// Marks an unused out edge of an NFA state and a transition of a subset that is not computed yet
+#define NFA_NO_STATE ((unsigned) -1)
+
+// State of a Thompson NFA. A state either reads one of its letters and moves to out[0],
+// or it has no letters and moves to out[0] and out[1] (if used) without reading anything.
+typedef struct NFA_State {
+    unsigned long long letters[4];
+    int reads_letter;
+    unsigned out[2];
+} NFA_State;
+
+// NFA built from a regular expression. It has a single accepting state with no out edges.
+typedef struct Regex_NFA {
+    NFA_State *states;
+    unsigned number_of_states;
+    unsigned capacity;
+
+    unsigned start_state, accept_state;
+} Regex_NFA;
+
+// Parses the regular expression and builds its NFA.
+// Returns NULL and sets the error message if the expression is invalid.
+struct Regex_NFA *make_regex_NFA(const char *pattern, char **error_message);
+
+void delete_regex_NFA(struct Regex_NFA*);
+
+// Builds the DFA of an NFA one transition at a time (subset construction).
+// Every DFA state is a set of NFA states closed under moves that read nothing; equal sets are found with
+// a hash table, so each set becomes a single DFA state. Letters that no NFA state tells apart share
+// a letter class, and transitions are computed per class when they are first asked for.
+struct Subset_Builder;
+
+// Instantiates a builder whose only subset, 0, is the start state of the NFA. The NFA must outlive the builder.
+struct Subset_Builder *make_subset_builder(const struct Regex_NFA*);
+
+void delete_subset_builder(struct Subset_Builder*);
+
+// Returns the subset reached from the subset with the letter, computing it if needed
+unsigned get_subset_transition(struct Subset_Builder*, unsigned subset, unsigned char letter);
+
+// Returns 1 if the subset holds the accepting NFA state, otherwise 0
+int is_subset_final(const struct Subset_Builder*, unsigned subset);
+
+// Returns 1 if the subset is empty, i.e. no input read from it is ever accepted
+int is_subset_empty(const struct Subset_Builder*, unsigned subset);
+
+unsigned get_number_of_subsets(const struct Subset_Builder*);
+
+// Returns the number of bytes taken by the subsets and their transitions
+size_t get_subset_builder_size(const struct Subset_Builder*);
+
+// Forgets every subset and transition but the start subset and the given one, keeping the memory for reuse.
+// Returns the new ID of the kept subset.
+unsigned clear_subset_builder(struct Subset_Builder*, unsigned kept_subset);
+
+#endif
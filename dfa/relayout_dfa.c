@@ -0,0 +1,110 @@
+#include <stdlib.h>
+#include "compiled_dfa.h"
+
+// State with its sorting key: the weight (higher first) and then the breadth first order from state 0
+typedef struct Ranked_State {
+    unsigned long long weight;
+    unsigned rank, state;
+} Ranked_State;
+
+// Helper functions declarations
+
+int compare_ranked_states(const void *a, const void *b);
+
+// Sets rank[s] to the position of the state in the breadth first order from state 0.
+// States that cannot be reached follow in the order of their IDs, and the garbage state is last.
+void rank_states_breadth_first(const Compiled_DFA *compiled, unsigned *rank);
+
+// Definitions of functions from "compiled_dfa.h"
+
+Compiled_DFA *relayout_compiled_DFA(const Compiled_DFA *compiled, const unsigned long long *weights, unsigned *new_ids) {
+    unsigned number_of_states = compiled->garbage_state;
+    unsigned number_of_classes = compiled->number_of_classes;
+    unsigned *rank = (unsigned*) malloc(compiled->number_of_states * sizeof(unsigned));
+    rank_states_breadth_first(compiled, rank);
+
+    // State 0 stays the start, so it is placed first whatever its weight
+    Ranked_State *order = (Ranked_State*) malloc((number_of_states + 1) * sizeof(Ranked_State));
+    for (unsigned s = 0; s < number_of_states; s++) {
+        order[s].weight = weights != NULL && s != 0 ? weights[s] : 0;
+        order[s].rank = rank[s];
+        order[s].state = s;
+    }
+    if (number_of_states > 1) {
+        qsort(order + 1, number_of_states - 1, sizeof(Ranked_State), compare_ranked_states);
+    }
+
+    unsigned *new_id = new_ids != NULL ? new_ids : rank;
+    for (unsigned i = 0; i < number_of_states; i++) {
+        new_id[order[i].state] = i;
+    }
+    new_id[compiled->garbage_state] = number_of_states;
+
+    unsigned *class_transitions = (unsigned*) malloc(((size_t) number_of_states * number_of_classes + 1) * sizeof(unsigned));
+    unsigned *final_states = (unsigned*) malloc((number_of_states + 1) * sizeof(unsigned));
+    unsigned final_states_count = 0;
+    for (unsigned i = 0; i < number_of_states; i++) {
+        unsigned state = order[i].state;
+        for (unsigned c = 0; c < number_of_classes; c++) {
+            class_transitions[(size_t) i * number_of_classes + c] = new_id[get_compiled_class_transition(compiled, state, c)];
+        }
+        if (is_compiled_state_final(compiled, state)) {
+            final_states[final_states_count++] = i;
+        }
+    }
+
+    Compiled_DFA *relayout = build_compiled_DFA_from_classes(
+        number_of_states, compiled->letter_classes, number_of_classes, class_transitions, final_states, final_states_count,
+        &compiled->allocator
+    );
+    free(rank);
+    free(order);
+    free(class_transitions);
+    free(final_states);
+    return relayout;
+}
+
+// Definitions of functions from "dfa.h"
+
+struct DFA *relayout_DFA(struct DFA *dfa, const unsigned long long *weights, unsigned *new_ids) {
+    return make_DFA_from_compiled(relayout_compiled_DFA(get_compiled_DFA(dfa), weights, new_ids));
+}
+
+// Helper functions definitions
+
+int compare_ranked_states(const void *a, const void *b) {
+    const Ranked_State *x = (const Ranked_State*) a, *y = (const Ranked_State*) b;
+    if (x->weight != y->weight) {
+        return x->weight > y->weight ? -1 : 1;
+    }
+    return (x->rank > y->rank) - (x->rank < y->rank);
+}
+
+void rank_states_breadth_first(const Compiled_DFA *compiled, unsigned *rank) {
+    unsigned *queue = (unsigned*) malloc(compiled->number_of_states * sizeof(unsigned));
+    for (unsigned s = 0; s < compiled->number_of_states; s++) {
+        rank[s] = compiled->number_of_states;
+    }
+    rank[compiled->garbage_state] = compiled->number_of_states - 1;
+
+    unsigned count = 0;
+    if (compiled->garbage_state != 0) {
+        rank[0] = count;
+        queue[count++] = 0;
+    }
+    for (unsigned head = 0; head < count; head++) {
+        for (unsigned c = 0; c < compiled->number_of_classes; c++) {
+            unsigned destination = get_compiled_class_transition(compiled, queue[head], c);
+            if (rank[destination] == compiled->number_of_states) {
+                rank[destination] = count;
+                queue[count++] = destination;
+            }
+        }
+    }
+    for (unsigned s = 0; s < compiled->garbage_state; s++) {
+        if (rank[s] == compiled->number_of_states) {
+            rank[s] = count++;
+        }
+    }
+    free(queue);
+}
@@ -0,0 +1,138 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include "shared_dfa.h"
+#include "read_dfa_from_file.h"
+
+// Readers are counted in this many slots per phase, so that threads do not all update the same counter
+#define READER_SLOTS 16
+
+#define CACHE_LINE_SIZE 64
+
+// Number of readers in a slot, alone on its cache line
+typedef struct Reader_Slot {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint readers;
+} Reader_Slot;
+
+// Readers register in the slots of the current phase. Publishing switches the phase and waits
+// for the slots of the previous one to empty, after which no reader can hold the replaced DFA.
+typedef struct Shared_DFA {
+    Reader_Slot slots[2][READER_SLOTS];
+    _Alignas(CACHE_LINE_SIZE) _Atomic(struct DFA*) published;
+    atomic_uint phase;
+
+    // Publishing threads take turns
+    pthread_mutex_t publish_mutex;
+} Shared_DFA;
+
+// Slot of the calling thread plus 1, or 0 if it has not been assigned yet
+static _Thread_local unsigned reader_slot;
+static atomic_uint next_reader_slot;
+
+// Helper functions declarations
+
+unsigned get_reader_slot();
+
+// Waits until the slots of the phase have no readers
+void wait_for_readers(Shared_DFA *shared, unsigned phase);
+
+// Definitions of functions from "shared_dfa.h"
+
+Shared_DFA *make_shared_DFA(struct DFA *dfa) {
+    Shared_DFA *shared = (Shared_DFA*) aligned_alloc(_Alignof(Shared_DFA), sizeof(Shared_DFA));
+    for (unsigned phase = 0; phase < 2; phase++) {
+        for (unsigned slot = 0; slot < READER_SLOTS; slot++) {
+            atomic_init(&shared->slots[phase][slot].readers, 0);
+        }
+    }
+
+    // The table is built now, since runs that build it would modify the DFA while other threads read it
+    build_DFA_table(dfa);
+    atomic_init(&shared->published, dfa);
+    atomic_init(&shared->phase, 0);
+    pthread_mutex_init(&shared->publish_mutex, NULL);
+    return shared;
+}
+
+void delete_shared_DFA(Shared_DFA *shared) {
+    if (shared != NULL) {
+        delete_DFA(atomic_load(&shared->published));
+        pthread_mutex_destroy(&shared->publish_mutex);
+        free(shared);
+    }
+}
+
+int run_shared_DFA(Shared_DFA *shared, const char *input, unsigned length) {
+    unsigned ticket;
+    struct DFA *dfa = acquire_shared_DFA(shared, &ticket);
+    int result = run_DFA(dfa, input, length);
+    release_shared_DFA(shared, ticket);
+    return result;
+}
+
+struct DFA *acquire_shared_DFA(Shared_DFA *shared, unsigned *ticket) {
+    unsigned slot = get_reader_slot();
+    unsigned phase = atomic_load(&shared->phase) & 1;
+    atomic_fetch_add(&shared->slots[phase][slot].readers, 1);
+
+    // If the phase switched in the meantime, a publisher may have already checked the slot, so the reader
+    // registers again in the new phase. Once the phase is confirmed, the DFA read below is released
+    // only after this reader leaves the slot.
+    unsigned current_phase = atomic_load(&shared->phase) & 1;
+    while (current_phase != phase) {
+        atomic_fetch_sub(&shared->slots[phase][slot].readers, 1);
+        phase = current_phase;
+        atomic_fetch_add(&shared->slots[phase][slot].readers, 1);
+        current_phase = atomic_load(&shared->phase) & 1;
+    }
+
+    *ticket = phase * READER_SLOTS + slot;
+    return atomic_load(&shared->published);
+}
+
+void release_shared_DFA(Shared_DFA *shared, unsigned ticket) {
+    atomic_fetch_sub(&shared->slots[ticket / READER_SLOTS][ticket % READER_SLOTS].readers, 1);
+}
+
+void publish_shared_DFA(Shared_DFA *shared, struct DFA *dfa) {
+    build_DFA_table(dfa);
+    pthread_mutex_lock(&shared->publish_mutex);
+    struct DFA *replaced = atomic_exchange(&shared->published, dfa);
+
+    // Readers that register from now on see the new DFA, so only the readers of the previous phase are waited for.
+    // Readers of the phase before that one were waited for by the previous publisher.
+    unsigned previous_phase = atomic_fetch_add(&shared->phase, 1) & 1;
+    wait_for_readers(shared, previous_phase);
+    pthread_mutex_unlock(&shared->publish_mutex);
+
+    delete_DFA(replaced);
+}
+
+int reload_shared_DFA(Shared_DFA *shared, const char *filename, int enabled_error_printing) {
+    struct DFA *dfa = read_dfa_from_file(filename, enabled_error_printing);
+    if (dfa == NULL) {
+        return 0;
+    }
+    publish_shared_DFA(shared, dfa);
+    return 1;
+}
+
+// Helper functions definitions
+
+unsigned get_reader_slot() {
+    if (reader_slot == 0) {
+        reader_slot = atomic_fetch_add(&next_reader_slot, 1) % READER_SLOTS + 1;
+    }
+    return reader_slot - 1;
+}
+
+void wait_for_readers(Shared_DFA *shared, unsigned phase) {
+    // A slot that was seen empty stays free of readers of the phase, since those that register late see
+    // the switched phase and move to the other slots
+    for (unsigned slot = 0; slot < READER_SLOTS; slot++) {
+        while (atomic_load(&shared->slots[phase][slot].readers) != 0) {
+            sched_yield();
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#include <stddef.h>
+#include "dfa.h"
+
+// Handle to a DFA that many threads run at the same time while another thread replaces it.
+// Runs do not take locks: a thread announces that it is reading, reads the published DFA and announces that it is done.
+// A replaced DFA is deleted only once every run that could have read it has finished.
+// Published DFAs belong to the handle and must not be modified or deleted by anyone else.
+struct Shared_DFA;
+
+// Instantiates a handle that publishes the given DFA (which may not be NULL) and takes ownership of it
+struct Shared_DFA *make_shared_DFA(struct DFA*);
+
+// Deletes the handle together with the DFA it publishes. No thread may be using the handle any more.
+void delete_shared_DFA(struct Shared_DFA*);
+
+// Returns 1 if the input is ACCEPTED by the DFA published when the run started, 0 if it is REJECTED
+int run_shared_DFA(struct Shared_DFA*, const char *input, unsigned length);
+
+// Returns the published DFA, which stays valid until release_shared_DFA is called with the ticket it sets.
+// Meant for running the DFA through other functions (e.g. run_DFA_batch or scan_DFA) while it may be replaced.
+// The thread must not publish a DFA on the same handle before it releases this one.
+struct DFA *acquire_shared_DFA(struct Shared_DFA*, unsigned *ticket);
+
+void release_shared_DFA(struct Shared_DFA*, unsigned ticket);
+
+// Publishes the DFA (which may not be NULL) in place of the current one, then waits until no thread uses
+// the current one any more and deletes it. Runs that start after this call see the new DFA.
+// DFAs are published one at a time, so concurrent calls wait for each other.
+void publish_shared_DFA(struct Shared_DFA*, struct DFA*);
+
+// Loads the DFA from the file (see read_dfa_from_file) and publishes it.
+// Returns 1 if it was published, or 0 if it could not be loaded, in which case the current DFA stays published.
+// Pass a non-zero integer for the third parameter to enable printing of errors (in case of any)
+int reload_shared_DFA(struct Shared_DFA*, const char *filename, int enabled_error_printing);
@@ -0,0 +1,331 @@
+#include <stdlib.h>
+#include <string.h>
+#include "regex_nfa.h"
+#include "compiled_dfa.h"
+
+typedef struct Subset_Builder {
+    const Regex_NFA *nfa;
+
+    // Letters that every NFA state treats the same share a class; class_letter holds one letter of every class
+    unsigned char letter_classes[DFA_ALPHABET_SIZE];
+    unsigned char class_letter[DFA_ALPHABET_SIZE];
+    unsigned number_of_classes;
+
+    // NFA states of subset s, sorted: members[member_start[s] .. member_start[s + 1]).
+    // Only the states that read a letter and the accepting state are kept, the others only lead to them.
+    unsigned *members;
+    size_t members_capacity;
+    size_t *member_start;
+    unsigned number_of_subsets;
+    unsigned subsets_capacity;
+
+    unsigned *transitions; // number_of_classes per subset; NFA_NO_STATE until computed
+    unsigned char *is_final;
+
+    // Open addressing hash table of subsets: subset + 1, 0 marks an empty slot
+    unsigned *subset_index;
+    unsigned subset_index_capacity;
+
+    // Scratch space for closures. A state is visited in the current closure if its stamp equals the generation.
+    unsigned *stamps;
+    unsigned generation;
+    unsigned *stack;
+    unsigned *closure;
+} Subset_Builder;
+
+// Helper functions declarations
+
+// Splits the letters into classes by the letter sets of the NFA states
+void compute_NFA_letter_classes(Subset_Builder *builder);
+
+// Adds the closure of the states on the stack (which are marked as visited) as a subset, unless it exists.
+// Returns the ID of the subset.
+unsigned add_closure_as_subset(Subset_Builder *builder, unsigned stack_size);
+
+// Starts a new closure, in which no state is visited yet
+void begin_closure(Subset_Builder *builder);
+
+void push_NFA_state(Subset_Builder *builder, unsigned state, unsigned *stack_size);
+
+// Returns the slot of the subset index that holds the members, or the empty slot where they would be inserted
+unsigned find_subset_slot(const Subset_Builder *builder, const unsigned *members, size_t count);
+
+unsigned long long hash_subset(const unsigned *members, size_t count);
+
+void grow_subset_index(Subset_Builder *builder);
+
+int compare_NFA_states(const void *a, const void *b);
+
+// Definitions of functions from "regex_nfa.h"
+
+Subset_Builder *make_subset_builder(const Regex_NFA *nfa) {
+    Subset_Builder *builder = (Subset_Builder*) malloc(sizeof(Subset_Builder));
+    builder->nfa = nfa;
+    compute_NFA_letter_classes(builder);
+
+    builder->members_capacity = 64;
+    builder->members = (unsigned*) malloc(builder->members_capacity * sizeof(unsigned));
+    builder->subsets_capacity = 16;
+    builder->member_start = (size_t*) malloc((builder->subsets_capacity + 1) * sizeof(size_t));
+    builder->member_start[0] = 0;
+    builder->number_of_subsets = 0;
+    builder->transitions = (unsigned*) malloc(builder->subsets_capacity * builder->number_of_classes * sizeof(unsigned));
+    builder->is_final = (unsigned char*) malloc(builder->subsets_capacity);
+
+    builder->subset_index_capacity = 32;
+    builder->subset_index = (unsigned*) calloc(builder->subset_index_capacity, sizeof(unsigned));
+
+    builder->stamps = (unsigned*) calloc(nfa->number_of_states, sizeof(unsigned));
+    builder->generation = 0;
+    builder->stack = (unsigned*) malloc(nfa->number_of_states * sizeof(unsigned));
+    builder->closure = (unsigned*) malloc(nfa->number_of_states * sizeof(unsigned));
+
+    // Subset 0 is the closure of the start state
+    unsigned stack_size = 0;
+    begin_closure(builder);
+    push_NFA_state(builder, nfa->start_state, &stack_size);
+    add_closure_as_subset(builder, stack_size);
+    return builder;
+}
+
+void delete_subset_builder(Subset_Builder *builder) {
+    if (builder != NULL) {
+        free(builder->members);
+        free(builder->member_start);
+        free(builder->transitions);
+        free(builder->is_final);
+        free(builder->subset_index);
+        free(builder->stamps);
+        free(builder->stack);
+        free(builder->closure);
+        free(builder);
+    }
+}
+
+unsigned get_subset_transition(Subset_Builder *builder, unsigned subset, unsigned char letter) {
+    size_t cell = (size_t) subset * builder->number_of_classes + builder->letter_classes[letter];
+    if (builder->transitions[cell] != NFA_NO_STATE) {
+        return builder->transitions[cell];
+    }
+
+    // Move every member that reads the letter and close the result
+    const NFA_State *states = builder->nfa->states;
+    letter = builder->class_letter[builder->letter_classes[letter]];
+    unsigned stack_size = 0;
+    begin_closure(builder);
+    for (size_t i = builder->member_start[subset]; i < builder->member_start[subset + 1]; i++) {
+        const NFA_State *state = &states[builder->members[i]];
+        if (state->reads_letter && (state->letters[letter / 64] >> (letter % 64)) & 1) {
+            push_NFA_state(builder, state->out[0], &stack_size);
+        }
+    }
+
+    unsigned destination = add_closure_as_subset(builder, stack_size);
+    builder->transitions[cell] = destination;
+    return destination;
+}
+
+int is_subset_final(const Subset_Builder *builder, unsigned subset) {
+    return builder->is_final[subset];
+}
+
+int is_subset_empty(const Subset_Builder *builder, unsigned subset) {
+    return builder->member_start[subset] == builder->member_start[subset + 1] ? 1 : 0;
+}
+
+unsigned get_number_of_subsets(const Subset_Builder *builder) {
+    return builder->number_of_subsets;
+}
+
+size_t get_subset_builder_size(const Subset_Builder *builder) {
+    size_t per_subset = builder->number_of_classes * sizeof(unsigned) + sizeof(size_t) + 1;
+    return builder->number_of_subsets * per_subset
+        + builder->member_start[builder->number_of_subsets] * sizeof(unsigned)
+        + builder->subset_index_capacity * sizeof(unsigned);
+}
+
+unsigned clear_subset_builder(Subset_Builder *builder, unsigned kept_subset) {
+    size_t start = builder->member_start[kept_subset], count = builder->member_start[kept_subset + 1] - start;
+    unsigned *kept_members = (unsigned*) malloc((count + 1) * sizeof(unsigned));
+    memcpy(kept_members, builder->members + start, count * sizeof(unsigned));
+
+    builder->number_of_subsets = 0;
+    memset(builder->subset_index, 0, builder->subset_index_capacity * sizeof(unsigned));
+
+    // Subset 0 is the closure of the start state again. The kept members are already closed,
+    // so closing them again gives the same subset.
+    unsigned stack_size = 0;
+    begin_closure(builder);
+    push_NFA_state(builder, builder->nfa->start_state, &stack_size);
+    add_closure_as_subset(builder, stack_size);
+
+    stack_size = 0;
+    begin_closure(builder);
+    for (size_t i = 0; i < count; i++) {
+        push_NFA_state(builder, kept_members[i], &stack_size);
+    }
+    free(kept_members);
+    return add_closure_as_subset(builder, stack_size);
+}
+
+// Helper functions definitions
+
+void compute_NFA_letter_classes(Subset_Builder *builder) {
+    const Regex_NFA *nfa = builder->nfa;
+    memset(builder->letter_classes, 0, sizeof(builder->letter_classes));
+    builder->number_of_classes = 1;
+
+    // Refining by the same set twice changes nothing, so the sets already used are remembered
+    unsigned seen_capacity = 64, seen_count = 0;
+    unsigned *seen = (unsigned*) malloc(seen_capacity * sizeof(unsigned));
+
+    for (unsigned s = 0; s < nfa->number_of_states; s++) {
+        const unsigned long long *letters = nfa->states[s].letters;
+        if (!nfa->states[s].reads_letter) {
+            continue;
+        }
+        int is_seen = 0;
+        for (unsigned i = 0; i < seen_count && !is_seen; i++) {
+            is_seen = memcmp(nfa->states[seen[i]].letters, letters, sizeof(nfa->states[s].letters)) == 0;
+        }
+        if (is_seen) {
+            continue;
+        }
+        if (seen_count == seen_capacity) {
+            seen_capacity *= 2;
+            seen = realloc(seen, seen_capacity * sizeof(unsigned));
+        }
+        seen[seen_count++] = s;
+
+        // Every class splits into the letters in the set and the rest
+        int split_class[DFA_ALPHABET_SIZE][2];
+        memset(split_class, -1, sizeof(split_class));
+        unsigned number_of_classes = 0;
+        for (unsigned letter = 0; letter < DFA_ALPHABET_SIZE; letter++) {
+            int in_set = (letters[letter / 64] >> (letter % 64)) & 1;
+            int *new_class = &split_class[builder->letter_classes[letter]][in_set];
+            if (*new_class < 0) {
+                *new_class = (int) number_of_classes++;
+            }
+            builder->letter_classes[letter] = (unsigned char) *new_class;
+        }
+        builder->number_of_classes = number_of_classes;
+        if (number_of_classes == DFA_ALPHABET_SIZE) {
+            break;
+        }
+    }
+    free(seen);
+
+    for (unsigned letter = DFA_ALPHABET_SIZE; letter-- > 0; ) {
+        builder->class_letter[builder->letter_classes[letter]] = (unsigned char) letter;
+    }
+}
+
+void begin_closure(Subset_Builder *builder) {
+    if (++builder->generation == 0) {
+        memset(builder->stamps, 0, builder->nfa->number_of_states * sizeof(unsigned));
+        builder->generation = 1;
+    }
+}
+
+void push_NFA_state(Subset_Builder *builder, unsigned state, unsigned *stack_size) {
+    if (builder->stamps[state] != builder->generation) {
+        builder->stamps[state] = builder->generation;
+        builder->stack[(*stack_size)++] = state;
+    }
+}
+
+unsigned add_closure_as_subset(Subset_Builder *builder, unsigned stack_size) {
+    const Regex_NFA *nfa = builder->nfa;
+    size_t count = 0;
+    int is_final = 0;
+    while (stack_size > 0) {
+        unsigned state = builder->stack[--stack_size];
+        const NFA_State *nfa_state = &nfa->states[state];
+        if (nfa_state->reads_letter || state == nfa->accept_state) {
+            builder->closure[count++] = state;
+            is_final = is_final || state == nfa->accept_state;
+        }
+        if (!nfa_state->reads_letter) {
+            for (unsigned i = 0; i < 2 && nfa_state->out[i] != NFA_NO_STATE; i++) {
+                push_NFA_state(builder, nfa_state->out[i], &stack_size);
+            }
+        }
+    }
+    qsort(builder->closure, count, sizeof(unsigned), compare_NFA_states);
+
+    if (2 * (builder->number_of_subsets + 1) > builder->subset_index_capacity) {
+        grow_subset_index(builder);
+    }
+    unsigned slot = find_subset_slot(builder, builder->closure, count);
+    if (builder->subset_index[slot] != 0) {
+        return builder->subset_index[slot] - 1;
+    }
+
+    // A new subset
+    unsigned subset = builder->number_of_subsets;
+    if (subset == builder->subsets_capacity) {
+        builder->subsets_capacity *= 2;
+        builder->member_start = realloc(builder->member_start, (builder->subsets_capacity + 1) * sizeof(size_t));
+        builder->transitions = realloc(builder->transitions, (size_t) builder->subsets_capacity * builder->number_of_classes * sizeof(unsigned));
+        builder->is_final = realloc(builder->is_final, builder->subsets_capacity);
+    }
+    size_t start = builder->member_start[subset];
+    if (start + count > builder->members_capacity) {
+        while (start + count > builder->members_capacity) {
+            builder->members_capacity *= 2;
+        }
+        builder->members = realloc(builder->members, builder->members_capacity * sizeof(unsigned));
+    }
+    memcpy(builder->members + start, builder->closure, count * sizeof(unsigned));
+    builder->member_start[subset + 1] = start + count;
+
+    builder->is_final[subset] = (unsigned char) is_final;
+    for (unsigned c = 0; c < builder->number_of_classes; c++) {
+        builder->transitions[(size_t) subset * builder->number_of_classes + c] = NFA_NO_STATE;
+    }
+
+    builder->subset_index[slot] = ++builder->number_of_subsets;
+    return subset;
+}
+
+unsigned find_subset_slot(const Subset_Builder *builder, const unsigned *members, size_t count) {
+    unsigned mask = builder->subset_index_capacity - 1;
+    unsigned slot = (unsigned) (hash_subset(members, count) >> 32) & mask;
+
+    while (builder->subset_index[slot] != 0) {
+        unsigned subset = builder->subset_index[slot] - 1;
+        size_t start = builder->member_start[subset];
+        if (builder->member_start[subset + 1] - start == count
+            && memcmp(builder->members + start, members, count * sizeof(unsigned)) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+unsigned long long hash_subset(const unsigned *members, size_t count) {
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < count; i++) {
+        hash = (hash ^ members[i]) * 0x100000001b3ULL;
+    }
+    return hash * 0x9E3779B97F4A7C15ULL;
+}
+
+void grow_subset_index(Subset_Builder *builder) {
+    free(builder->subset_index);
+    builder->subset_index_capacity *= 2;
+    builder->subset_index = (unsigned*) calloc(builder->subset_index_capacity, sizeof(unsigned));
+
+    for (unsigned subset = 0; subset < builder->number_of_subsets; subset++) {
+        size_t start = builder->member_start[subset];
+        unsigned slot = find_subset_slot(builder, builder->members + start, builder->member_start[subset + 1] - start);
+        builder->subset_index[slot] = subset + 1;
+    }
+}
+
+int compare_NFA_states(const void *a, const void *b) {
+    unsigned x = *(const unsigned*) a, y = *(const unsigned*) b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
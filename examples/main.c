@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../dfa/read_dfa_from_file.h"
+#include "../dfa/shared_dfa.h"
 
 void clear_screen() {
     printf("\e[1;1H\e[2J");
@@ -41,7 +42,7 @@ void print_menu(int selected, int last_option) {
     );
 }
 
-struct DFA *select_different_dfa(char *c_ptr, struct DFA *dfa, int *selected) {
+void select_different_dfa(char *c_ptr, struct Shared_DFA *dfa, int *selected) {
     char c = *c_ptr;
     c = clear_input(c);
     clear_screen();
@@ -50,11 +51,9 @@ struct DFA *select_different_dfa(char *c_ptr, struct DFA *dfa, int *selected) {
     if ('1' <= c && c <= '3') {
         char filename[60];
         snprintf(filename, 60, "example-%c.txt", c); 
-        struct DFA *new_dfa = read_dfa_from_file(filename, 1);
-        if (new_dfa != NULL) {
+        // Threads that are still running the old DFA keep it until they finish
+        if (reload_shared_DFA(dfa, filename, 1)) {
             *selected = c - '0';
-            delete_DFA(dfa);
-            dfa = new_dfa;
             printf("\nSuccessfully loaded... \n");
         } else {
             printf("\nLoading new DFA failed...\n");
@@ -68,10 +67,9 @@ struct DFA *select_different_dfa(char *c_ptr, struct DFA *dfa, int *selected) {
     printf("\n\nPress ENTER to continue... ");
     c = getchar();
     *c_ptr = clear_input(c);
-    return dfa;
 }
 
-void run_word(char *c_ptr, struct DFA *dfa) {
+void run_word(char *c_ptr, struct Shared_DFA *dfa) {
     char c = *c_ptr;
     c = clear_input(c);
     int word_size = 50;
@@ -93,7 +91,7 @@ void run_word(char *c_ptr, struct DFA *dfa) {
     }
     printf(
         "\n\nWord \"%s\" is %s by the DFA...\n" , word,
-        run_DFA(dfa, word, strlen(word)) == 1 ? "ACCEPTED" : "REJECTED"
+        run_shared_DFA(dfa, word, strlen(word)) == 1 ? "ACCEPTED" : "REJECTED"
     );
 
     free(word);
@@ -105,7 +103,11 @@ void run_word(char *c_ptr, struct DFA *dfa) {
 
 int main() {
     int selected = 1;
-    struct DFA *dfa = read_dfa_from_file("./example-1.txt", 1);
+    struct DFA *first_dfa = read_dfa_from_file("./example-1.txt", 1);
+    if (first_dfa == NULL) {
+        return 1;
+    }
+    struct Shared_DFA *dfa = make_shared_DFA(first_dfa);
     int done = 0;
     char c = '\n';
     int option = 0;
@@ -119,7 +121,7 @@ int main() {
         switch (c)
         {
         case '1':
-            dfa = select_different_dfa(&c, dfa, &selected);
+            select_different_dfa(&c, dfa, &selected);
             break;
         case '2':
             run_word(&c, dfa);
@@ -130,6 +132,6 @@ int main() {
         }
     } while(done == 0);
     
-    delete_DFA(dfa);
+    delete_shared_DFA(dfa);
     return 0;
 }
\ No newline at end of file